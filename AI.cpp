@@ -2,42 +2,40 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
+#include "AllocTracker.hpp"
 
 using json = nlohmann::json;
 using namespace std;
 
 namespace ai {
 
-LinearRegression::LinearRegression(double lr) : alpha(lr) {
-    weights.resize(6, 0.1); // bias + 5 taste weights
+template <size_t N>
+BasicLinearRegression<N>::BasicLinearRegression(double lr, double decay) : alpha(lr), l2(decay) {
+    weights.fill(0.1); // bias + N taste weights
 }
 
-double LinearRegression::predict(const vector<double> &x) const {
-    double y_hat = 0.0;
-    if (weights.empty()) return y_hat;
-    y_hat = weights[0]; // bias
-    size_t n = min<size_t>(5, x.size());
-    for (size_t i = 0; i < n; ++i) {
-        y_hat += weights[i + 1] * x[i];
-    }
-    return y_hat;
+template <size_t N>
+double BasicLinearRegression<N>::predict(const Input &x) const {
+    return weights[0] + menu::dot<N>(&weights[1], x.data()); // bias + w.x
 }
 
-void LinearRegression::train(const vector<double> &x, double y) {
+template <size_t N>
+void BasicLinearRegression<N>::train(const Input &x, double y) {
     double y_hat = predict(x);
     double err = (y - y_hat);
-    // update weights w1..w5
-    size_t n = min<size_t>(5, x.size());
-    for (size_t i = 0; i < n; ++i) {
-        weights[i + 1] += alpha * err * x[i];
-    }
+    // update weights w1..wN
+    menu::sumOver<N>([&](auto i) { weights[i + 1] += alpha * err * x[i] - alpha * l2 * weights[i + 1]; return 0.0; });
     // update bias
     weights[0] += alpha * err;
 }
 
-void LinearRegression::saveWeights(const string &filename) const {
+template <size_t N>
+void BasicLinearRegression<N>::saveWeights(const string &filename) const {
+    menu::AllocPhaseScope phase(menu::AllocPhase::Model);
     json j;
     j["weights"] = weights;
+    j["alpha"] = alpha;
+    j["l2"] = l2;
     ofstream file(filename);
     if (!file.is_open()) {
         cerr << "Warning: could not open " << filename << " to save weights\n";
@@ -46,7 +44,9 @@ void LinearRegression::saveWeights(const string &filename) const {
     file << j.dump(4);
 }
 
-void LinearRegression::loadWeights(const string &filename) {
+template <size_t N>
+void BasicLinearRegression<N>::loadWeights(const string &filename) {
+    menu::AllocPhaseScope phase(menu::AllocPhase::Model);
     ifstream file(filename);
     if (!file.is_open()) {
         // no saved weights -> keep defaults
@@ -55,20 +55,28 @@ void LinearRegression::loadWeights(const string &filename) {
     try {
         json j;
         file >> j;
-        if (j.contains("weights") && j["weights"].is_array()) {
-            auto arr = j["weights"];
-            vector<double> w;
-            for (auto &v : arr) w.push_back(v.get<double>());
-            if (w.size() >= 1) weights = w;
-            // ensure length 6
-            if (weights.size() < 6) weights.resize(6, 0.0);
+        if (j.contains("weights") && j["weights"].is_array() && !j["weights"].empty()) {
+            auto &arr = j["weights"];
+            // missing trailing weights (file from a smaller build) start at 0, extras are ignored
+            weights.fill(0.0);
+            for (size_t i = 0; i < arr.size() && i < weights.size(); ++i) weights[i] = arr[i].get<double>();
         }
+        // hyperparameters chosen by --select-model override the constructor's
+        if (j.contains("alpha") && j["alpha"].is_number()) alpha = j["alpha"].get<double>();
+        if (j.contains("l2") && j["l2"].is_number()) l2 = j["l2"].get<double>();
     } catch (const std::exception &e) {
         cerr << "Error loading weights: " << e.what() << "\n";
     }
 }
 
-void LinearRegression::printWeights() const {
+template <size_t N>
+const array<double, N + 1> &BasicLinearRegression<N>::getWeights() const { return weights; }
+
+template <size_t N>
+void BasicLinearRegression<N>::setWeights(const array<double, N + 1> &w) { weights = w; }
+
+template <size_t N>
+void BasicLinearRegression<N>::printWeights() const {
     cout << "LinearRegression weights: [";
     for (size_t i = 0; i < weights.size(); ++i) {
         cout << weights[i];
@@ -77,4 +85,11 @@ void LinearRegression::printWeights() const {
     cout << "]\n";
 }
 
+template class BasicLinearRegression<5>;
+template class BasicLinearRegression<8>;
+template class BasicLinearRegression<16>;
+#if MENU_TASTE_DIMS != 5 && MENU_TASTE_DIMS != 8 && MENU_TASTE_DIMS != 16
+template class BasicLinearRegression<MENU_TASTE_DIMS>;
+#endif
+
 } // namespace ai
@@ -1,28 +1,43 @@
 #ifndef AI_HPP
 #define AI_HPP
 
+#include <array>
 #include <iostream>
 #include <vector>
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include "Taste.hpp"
 
 namespace ai {
 
-class LinearRegression {
+// linear model over an N-dimensional taste vector; explicitly instantiated
+// in AI.cpp for 5, 8, 16 and the build's MENU_TASTE_DIMS
+template <std::size_t N>
+class BasicLinearRegression {
 private:
-    std::vector<double> weights; // w0..w5
+    std::array<double, N + 1> weights; // w0 (bias), w1..wN
     double alpha; // learning rate
+    double l2;    // weight decay on w1..wN (not the bias)
 
 public:
-    LinearRegression(double lr = 0.01);
+    static constexpr std::size_t kDims = N;
+    using Input = menu::TasteVec<N>;
 
-    double predict(const std::vector<double> &x) const;
-    void train(const std::vector<double> &x, double y);
+    BasicLinearRegression(double lr = 0.01, double decay = 0.0);
+
+    double predict(const Input &x) const;
+    void train(const Input &x, double y);
     void saveWeights(const std::string &filename) const;
     void loadWeights(const std::string &filename);
     void printWeights() const;
+    const std::array<double, N + 1> &getWeights() const; // [bias, w1..wN]
+    void setWeights(const std::array<double, N + 1> &w);
+    double getLearningRate() const { return alpha; }
+    double getL2() const { return l2; }
 };
 
+using LinearRegression = BasicLinearRegression<menu::kTasteDims>;
+
 } // namespace ai
 
 #endif
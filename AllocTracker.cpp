@@ -0,0 +1,128 @@
+#include "AllocTracker.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace menu {
+
+uint64_t AllocStats::totalCount() const {
+    uint64_t n = 0;
+    for (auto c : count) n += c;
+    return n;
+}
+
+uint64_t AllocStats::totalBytes() const {
+    uint64_t n = 0;
+    for (auto b : bytes) n += b;
+    return n;
+}
+
+AllocStats &AllocStats::operator+=(const AllocStats &o) {
+    for (size_t i = 0; i < kAllocPhaseCount; ++i) { count[i] += o.count[i]; bytes[i] += o.bytes[i]; }
+    overBudget = overBudget || o.overBudget;
+    return *this;
+}
+
+#ifdef MENU_ALLOC_TRACKING
+namespace detail {
+thread_local AllocThreadState tlsAlloc = {};
+}
+
+AllocRequest::AllocRequest(uint64_t budgetBytes) {
+    auto &s = detail::tlsAlloc;
+    memset(s.count, 0, sizeof(s.count));
+    memset(s.bytes, 0, sizeof(s.bytes));
+    s.total = 0;
+    s.budget = budgetBytes;
+    s.overBudget = false;
+    s.active = true;
+}
+
+AllocRequest::~AllocRequest() { detail::tlsAlloc.active = false; }
+
+AllocStats AllocRequest::stats() const {
+    const auto &s = detail::tlsAlloc;
+    AllocStats out;
+    for (size_t i = 0; i < kAllocPhaseCount; ++i) { out.count[i] = s.count[i]; out.bytes[i] = s.bytes[i]; }
+    out.overBudget = s.overBudget;
+    return out;
+}
+#else
+AllocRequest::AllocRequest(uint64_t) {}
+AllocRequest::~AllocRequest() {}
+AllocStats AllocRequest::stats() const { return AllocStats(); }
+#endif
+
+// whole numbers print as integers, averages with one decimal
+static void appendCount(string &out, double v) {
+    char tmp[32];
+    auto r = v == floor(v) ? to_chars(tmp, tmp + sizeof(tmp), static_cast<uint64_t>(v))
+                           : to_chars(tmp, tmp + sizeof(tmp), v, chars_format::fixed, 1);
+    out.append(tmp, r.ptr);
+}
+
+static void appendBytes(string &out, double b) {
+    static const char *kUnits[] = {"B", "KiB", "MiB", "GiB"};
+    size_t u = 0;
+    while (b >= 1024 && u + 1 < sizeof(kUnits) / sizeof(kUnits[0])) { b /= 1024; ++u; }
+    appendCount(out, u ? round(b * 10) / 10 : b);
+    out += ' ';
+    out += kUnits[u];
+}
+
+void writeAllocReport(string &out, const AllocStats &s, double divisor) {
+    if (!kAllocTracking) { out += "allocation tracking not built in (compile with -DMENU_ALLOC_TRACKING)"; return; }
+    if (divisor <= 0) divisor = 1;
+    for (size_t i = 0; i < kAllocPhaseCount; ++i) {
+        if (!s.count[i]) continue;
+        out += kAllocPhaseNames[i];
+        out += ' ';
+        appendCount(out, s.count[i] / divisor);
+        out += " (";
+        appendBytes(out, s.bytes[i] / divisor);
+        out += "), ";
+    }
+    out += "total ";
+    appendCount(out, s.totalCount() / divisor);
+    out += " (";
+    appendBytes(out, s.totalBytes() / divisor);
+    out += ')';
+    if (s.overBudget) out += " | OVER BUDGET";
+}
+
+} // namespace menu
+
+// ========== GLOBAL OPERATOR NEW ==========
+#ifdef MENU_ALLOC_TRACKING
+static void trackAllocation(size_t n) {
+    auto &s = menu::detail::tlsAlloc;
+    if (!s.active) return;
+    s.count[s.phase]++;
+    s.bytes[s.phase] += n;
+    s.total += n;
+    if (s.budget && s.total > s.budget && !s.overBudget) {
+        s.overBudget = true; // throw once; allocations during unwinding must still succeed
+        throw menu::AllocBudgetExceeded();
+    }
+}
+
+void *operator new(size_t n) {
+    trackAllocation(n);
+    if (void *p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t n) {
+    trackAllocation(n);
+    if (void *p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+#endif
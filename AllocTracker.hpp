@@ -0,0 +1,93 @@
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+namespace menu {
+
+// ========== ALLOCATION TRACKING ==========
+// Opt-in: build with -DMENU_ALLOC_TRACKING (every translation unit) to
+// replace the global operator new/delete. While an AllocRequest is open on a
+// thread, each allocation on that thread is counted against the innermost
+// AllocPhaseScope, and an optional per-request byte budget is enforced by
+// throwing AllocBudgetExceeded from operator new. Without the flag the
+// scopes are empty and everything below compiles away.
+#ifdef MENU_ALLOC_TRACKING
+constexpr bool kAllocTracking = true;
+#else
+constexpr bool kAllocTracking = false;
+#endif
+
+enum class AllocPhase : std::uint8_t { Other, Catalog, ParseTaste, MakeItem, Candidates, Model, Output, Count };
+constexpr std::size_t kAllocPhaseCount = static_cast<std::size_t>(AllocPhase::Count);
+constexpr std::array<const char *, kAllocPhaseCount> kAllocPhaseNames = {{
+    "other", "catalog", "parse-taste", "make-item", "candidates", "model", "output"
+}};
+
+struct AllocStats {
+    std::array<std::uint64_t, kAllocPhaseCount> count{};
+    std::array<std::uint64_t, kAllocPhaseCount> bytes{};
+    bool overBudget = false;
+
+    std::uint64_t totalCount() const;
+    std::uint64_t totalBytes() const;
+    AllocStats &operator+=(const AllocStats &o);
+};
+
+// thrown by operator new once a request passes its budget (only the first time per request)
+class AllocBudgetExceeded : public std::bad_alloc {
+public:
+    const char *what() const noexcept override { return "per-request memory budget exceeded"; }
+};
+
+namespace detail {
+// plain data so operator new can touch it without TLS constructors
+struct AllocThreadState {
+    bool active;
+    bool overBudget;
+    std::uint8_t phase;
+    std::uint64_t budget; // 0 = unlimited
+    std::uint64_t total;
+    std::uint64_t count[kAllocPhaseCount];
+    std::uint64_t bytes[kAllocPhaseCount];
+};
+#ifdef MENU_ALLOC_TRACKING
+extern thread_local AllocThreadState tlsAlloc;
+#endif
+} // namespace detail
+
+// attributes this thread's allocations to a phase until the scope ends
+class AllocPhaseScope {
+public:
+#ifdef MENU_ALLOC_TRACKING
+    explicit AllocPhaseScope(AllocPhase p) : prev(detail::tlsAlloc.phase) { detail::tlsAlloc.phase = static_cast<std::uint8_t>(p); }
+    ~AllocPhaseScope() { detail::tlsAlloc.phase = prev; }
+private:
+    std::uint8_t prev;
+#else
+    explicit AllocPhaseScope(AllocPhase) {}
+#endif
+};
+
+// one tracked request on the current thread; requests do not nest
+class AllocRequest {
+public:
+    explicit AllocRequest(std::uint64_t budgetBytes = 0);
+    ~AllocRequest();
+    AllocRequest(const AllocRequest &) = delete;
+    AllocRequest &operator=(const AllocRequest &) = delete;
+
+    AllocStats stats() const; // counters so far
+};
+
+// "parse-taste 12 (480 B), make-item 6 (1.2 KiB), total 18 (1.6 KiB)"; idle phases are skipped,
+// counts are divided by `divisor` (e.g. requests, for a per-request average)
+void writeAllocReport(std::string &out, const AllocStats &s, double divisor = 1.0);
+
+} // namespace menu
+
+#endif
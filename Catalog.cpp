@@ -0,0 +1,216 @@
+#include "Catalog.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include "AllocTracker.hpp"
+
+using namespace std;
+
+namespace menu {
+
+// read named dimensions (kTasteNames), missing ones default to 0.5;
+// "spicy" is the legacy key of the fifth dimension and wins over "savory"
+static Taste tasteFromObject(const json &tb) {
+    Taste t = neutralTaste();
+    auto getv = [&](string_view k)->double {
+        auto f = tb.find(k);
+        if (f != tb.end() && f->is_number()) return f->get<double>();
+        return 0.5;
+    };
+    for (size_t i = 0; i < kTasteDims; ++i) t[i] = getv(kTasteNames[i]);
+    if (kTasteDims > 4 && tb.contains("spicy")) t[4] = getv("spicy");
+    return t;
+}
+
+// parse taste from various JSON forms
+Taste parseTasteFromJson(const json &it) {
+    AllocPhaseScope phase(AllocPhase::ParseTaste);
+    if (it.contains("taste")) {
+        if (it["taste"].is_array()) {
+            Taste t = neutralTaste();
+            size_t idx = 0;
+            for (auto &v : it["taste"]) if (idx < kTasteDims) t[idx++] = v.get<double>();
+            return t;
+        }
+        if (it["taste"].is_object()) return tasteFromObject(it["taste"]);
+    }
+
+    if (it.contains("taste_balance")) {
+        if (it["taste_balance"].is_number()) return uniformTaste<kTasteDims>(it["taste_balance"].get<double>());
+        if (it["taste_balance"].is_object()) return tasteFromObject(it["taste_balance"]);
+    }
+
+    return neutralTaste();
+}
+
+bool isVegetarianEntry(const json &it) {
+    if (it.contains("vegetarian") && it["vegetarian"].is_boolean()) return it["vegetarian"].get<bool>();
+    string low = it.value("name", string());
+    for (auto &c : low) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return low.find("veg") != string::npos || low.find("vegetable") != string::npos;
+}
+
+Catalog groupByCategory(json &&menuData) {
+    AllocPhaseScope phase(AllocPhase::Catalog);
+    Catalog part;
+    if (!menuData.is_object()) return part;
+    for (auto& [category, items] : menuData.items()) {
+        if (!items.is_array()) continue;
+        auto &dst = part[normalizeCategory(category)];
+        for (auto& it : items) dst.push_back(move(it));
+    }
+    return part;
+}
+
+string catalogEntryKey(const json &it) {
+    auto name = it.is_object() ? it.find("name") : it.end();
+    string key = name != it.end() && name->is_string() ? name->get<string>() : string();
+    for (auto &c : key) c = static_cast<char>(detail::foldCase(c));
+    return key;
+}
+
+namespace {
+// folded name -> position, per category; kept across merges so each entry is hashed once
+using CatalogIndex = map<string, unordered_map<string, size_t>>;
+
+size_t mergeIndexed(Catalog &into, CatalogIndex &index, Catalog &&part) {
+    size_t replaced = 0;
+    for (auto &[cat, items] : part) {
+        auto &dst = into[cat];
+        auto &idx = index[cat];
+        for (auto &it : items) {
+            string key = catalogEntryKey(it);
+            if (key.empty()) { dst.push_back(move(it)); continue; }
+            auto [pos, added] = idx.emplace(move(key), dst.size());
+            if (added) dst.push_back(move(it));
+            else { dst[pos->second] = move(it); ++replaced; }
+        }
+    }
+    return replaced;
+}
+} // namespace
+
+size_t mergeCatalog(Catalog &into, Catalog &&part) {
+    CatalogIndex index;
+    for (auto &[cat, items] : into)
+        for (size_t i = 0; i < items.size(); ++i) {
+            string key = catalogEntryKey(items[i]);
+            if (!key.empty()) index[cat].emplace(move(key), i);
+        }
+    return mergeIndexed(into, index, move(part));
+}
+
+vector<string> catalogSources(const string &path) {
+    namespace fs = std::filesystem;
+    vector<string> files;
+    error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (auto &e : fs::directory_iterator(path, ec))
+            if (e.is_regular_file(ec) && e.path().extension() == ".json") files.push_back(e.path().string());
+        sort(files.begin(), files.end());
+        if (files.empty()) cerr << "Warning: no .json files in " << path << "\n";
+        return files;
+    }
+    if (fs::path(path).extension() == ".json") return {path};
+
+    ifstream manifest(path);
+    if (!manifest.is_open()) return {path}; // reported by the loader
+    fs::path base = fs::path(path).parent_path();
+    string line;
+    while (getline(manifest, line)) {
+        size_t b = line.find_first_not_of(" \t\r"), e = line.find_last_not_of(" \t\r");
+        if (b == string::npos || line[b] == '#') continue;
+        fs::path p = line.substr(b, e - b + 1);
+        files.push_back((p.is_relative() ? base / p : p).string());
+    }
+    return files;
+}
+
+Catalog loadCatalogFiles(const vector<string> &files, unsigned threads, CatalogLoadStats *stats) {
+    // each task reads, parses and groups one file into its own slot; the merge is sequential, in list order
+    vector<Catalog> parts(files.size());
+    vector<char> ok(files.size(), 0);
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < files.size();) {
+            ifstream file(files[i]);
+            if (!file.is_open()) { cerr << "Warning: could not open catalog file " + files[i] + "\n"; continue; }
+            json doc = json::parse(file, nullptr, false);
+            if (doc.is_discarded() || !doc.is_object()) { cerr << "Warning: " + files[i] + " is not a JSON object of categories, skipped\n"; continue; }
+            parts[i] = groupByCategory(move(doc));
+            ok[i] = 1;
+        }
+    };
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    threads = static_cast<unsigned>(min<size_t>(threads, max<size_t>(1, files.size())));
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker(); // the calling thread takes a share too
+    for (auto &t : pool) t.join();
+
+    AllocPhaseScope phase(AllocPhase::Catalog);
+    Catalog catalog;
+    CatalogIndex index;
+    CatalogLoadStats st;
+    st.files = files.size();
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (!ok[i]) continue;
+        ++st.parsed;
+        st.duplicates += mergeIndexed(catalog, index, move(parts[i]));
+        Catalog().swap(parts[i]);
+    }
+    for (auto &kv : catalog) st.items += kv.second.size();
+
+    if (st.parsed) {
+        string missing;
+        for (const auto &info : kCategories) {
+            auto it = catalog.find(string(info.name));
+            if (it == catalog.end() || it->second.empty()) missing += (missing.empty() ? "" : ", ") + string(info.name);
+        }
+        if (!missing.empty()) cerr << "Warning: the catalog has no items for: " << missing << "\n";
+    }
+    if (stats) *stats = st;
+    return catalog;
+}
+
+shared_ptr<MenuItem> makeItemFromJson(Category category, const json &it) {
+    AllocPhaseScope phase(AllocPhase::MakeItem);
+    string n = it.value("name", string());
+    double p = it.value("price", 0.0);
+    Taste t = parseTasteFromJson(it);
+
+    return makeItem(category, n, p, t, isVegetarianEntry(it));
+}
+
+// ========== CATALOG VIEW ==========
+JsonCatalogView::JsonCatalogView(const Catalog &catalog) {
+    for (auto &kv : catalog) {
+        Category c = findCategory(kv.first);
+        size_t begin = entries.size();
+        for (auto &it : kv.second) entries.push_back({c, &it});
+        groups.emplace(kv.first, make_pair(begin, entries.size()));
+    }
+}
+
+pair<size_t, size_t> JsonCatalogView::groupRange(const string &key) const {
+    auto g = groups.find(key);
+    return g == groups.end() ? pair<size_t, size_t>(0, 0) : g->second;
+}
+
+CatalogItem JsonCatalogView::item(size_t idx) const {
+    const json &it = *entries[idx].source;
+    auto flag = it.find("vegetarian");
+    return {entries[idx].category, it.value("name", string()), it.value("price", 0.0), parseTasteFromJson(it),
+            isVegetarianEntry(it), flag != it.end() && flag->is_boolean()};
+}
+
+shared_ptr<MenuItem> JsonCatalogView::makeItem(size_t idx) const {
+    return makeItemFromJson(entries[idx].category, *entries[idx].source);
+}
+
+} // namespace menu
@@ -0,0 +1,100 @@
+#ifndef CATALOG_HPP
+#define CATALOG_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "Category.hpp"
+#include "Menu.hpp"
+#include "Taste.hpp"
+
+namespace menu {
+
+// category name -> raw JSON entries, as loaded from menu.json
+using Catalog = std::map<std::string, std::vector<json>>;
+
+// parse taste from various JSON forms (object with named keys, array, taste_balance)
+Taste parseTasteFromJson(const json &it);
+
+// explicit "vegetarian" flag, otherwise guessed from the name
+bool isVegetarianEntry(const json &it);
+
+// entries by normalized category, as they appear in the document (moved out of it), nothing merged
+Catalog groupByCategory(json &&menuData);
+
+// ========== MULTI-FILE INGESTION ==========
+// A catalog can be spread over many JSON files (per kitchen, per region).
+// They are parsed concurrently, one file per task, and merged in list order:
+// an entry whose category and name (case-insensitive) were already seen
+// replaces the earlier one in place, so later files override earlier ones.
+// Entries without a name are always kept.
+struct CatalogLoadStats {
+    std::size_t files = 0;      // sources listed
+    std::size_t parsed = 0;     // sources read and parsed
+    std::size_t items = 0;      // entries after the merge
+    std::size_t duplicates = 0; // entries replaced by a later one
+};
+
+// a directory (its *.json files, by name), a manifest (one path per line, relative
+// to the manifest, '#' comments) or a single JSON file
+std::vector<std::string> catalogSources(const std::string &path);
+
+// threads = 0 uses every core; unreadable files are skipped with a warning, and
+// registered categories that end up empty are reported
+Catalog loadCatalogFiles(const std::vector<std::string> &files, unsigned threads = 0, CatalogLoadStats *stats = nullptr);
+
+// what an entry is merged on: its case-folded name, "" if it has none (never merged)
+std::string catalogEntryKey(const json &it);
+
+// moves `part` into `into` under the rules above; returns the number of replaced entries
+std::size_t mergeCatalog(Catalog &into, Catalog &&part);
+std::shared_ptr<MenuItem> makeItemFromJson(Category category, const json &it);
+
+// ========== CATALOG VIEW ==========
+// Item-by-item access to a loaded catalog, whatever holds it, for the code
+// that lists or re-resolves single dishes (interact, the session store).
+// Items have a flat index: groups in map order, entries in file order.
+struct CatalogItem {
+    Category category;
+    std::string name;
+    double price;
+    Taste taste;
+    bool vegetarian; // explicit flag, otherwise guessed from the name
+    bool vegFlagged; // the entry has an explicit "vegetarian" flag
+};
+
+class CatalogView {
+public:
+    virtual ~CatalogView() = default;
+    virtual std::size_t itemCount() const = 0;
+    // flat index range [first, second) of a group (normalized category name); empty if absent
+    virtual std::pair<std::size_t, std::size_t> groupRange(const std::string &key) const = 0;
+    virtual CatalogItem item(std::size_t idx) const = 0;
+    virtual std::shared_ptr<MenuItem> makeItem(std::size_t idx) const = 0;
+};
+
+// a view over a Catalog, which must outlive it
+class JsonCatalogView : public CatalogView {
+public:
+    explicit JsonCatalogView(const Catalog &catalog);
+    std::size_t itemCount() const override { return entries.size(); }
+    std::pair<std::size_t, std::size_t> groupRange(const std::string &key) const override;
+    CatalogItem item(std::size_t idx) const override;
+    std::shared_ptr<MenuItem> makeItem(std::size_t idx) const override;
+
+private:
+    struct Entry {
+        Category category;
+        const json *source;
+    };
+    std::vector<Entry> entries;
+    std::map<std::string, std::pair<std::size_t, std::size_t>> groups;
+};
+
+} // namespace menu
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef CATEGORY_HPP
+#define CATEGORY_HPP
+
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace menu {
+
+// ========== CATEGORY REGISTRY ==========
+// One line per category: X(ClassName, extra aliases...). The enum, the name
+// table, the alias perfect hash, the item factory table (Menu.cpp) and the
+// required-category checks are all generated from this list. The lowercase
+// class name is always accepted, so aliases only list the other spellings.
+#define MENU_CATEGORIES(X) \
+    X(Starter,    "starters") \
+    X(Salad,      "salads") \
+    X(MainCourse, "main_courses", "main_course", "maincourses") \
+    X(Drink,      "drinks") \
+    X(Appetizer,  "appetizers") \
+    X(Dessert,    "desserts")
+
+enum class Category : std::uint8_t {
+#define MENU_CATEGORY_ENUM(cls, ...) cls,
+    MENU_CATEGORIES(MENU_CATEGORY_ENUM)
+#undef MENU_CATEGORY_ENUM
+    Unknown
+};
+
+constexpr std::size_t kCategoryCount = static_cast<std::size_t>(Category::Unknown);
+constexpr std::size_t kMaxCategoryAliases = 4;
+
+struct CategoryInfo {
+    Category id;
+    std::string_view name;
+    std::array<std::string_view, kMaxCategoryAliases> aliases;
+};
+
+template <class... Names>
+constexpr std::array<std::string_view, kMaxCategoryAliases> categoryAliases(Names... names) {
+    static_assert(sizeof...(Names) <= kMaxCategoryAliases, "too many aliases; raise kMaxCategoryAliases");
+    std::array<std::string_view, kMaxCategoryAliases> out{};
+    for (auto &o : out) o = std::string_view("", 0); // gcc 12 rejects value-initialized views here in constant evaluation
+    std::size_t i = 0;
+    ((out[i++] = names), ...);
+    return out;
+}
+
+constexpr std::array<CategoryInfo, kCategoryCount> kCategories = {{
+#define MENU_CATEGORY_INFO(cls, ...) CategoryInfo{Category::cls, #cls, categoryAliases(__VA_ARGS__)},
+    MENU_CATEGORIES(MENU_CATEGORY_INFO)
+#undef MENU_CATEGORY_INFO
+}};
+
+namespace detail {
+
+// ascii tolower without a branch or locale lookup
+constexpr unsigned char foldCase(char c) {
+    auto u = static_cast<unsigned char>(c);
+    return static_cast<unsigned char>(u | (static_cast<unsigned char>(u - 'A') < 26u) << 5);
+}
+
+constexpr bool equalsFolded(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (foldCase(a[i]) != foldCase(b[i])) return false;
+    return true;
+}
+
+// FNV-1a over case-folded bytes, perturbed by a seed picked at compile time
+constexpr std::uint32_t aliasHash(std::string_view s, std::uint32_t seed) {
+    std::uint32_t h = 2166136261u ^ seed;
+    for (char c : s) { h ^= foldCase(c); h *= 16777619u; }
+    return h;
+}
+
+constexpr std::size_t kAliasSlots = 64; // power of two, must be > number of aliases
+
+struct AliasSlot {
+    std::string_view key;
+    Category id = Category::Unknown;
+};
+
+struct AliasTable {
+    std::uint32_t seed = 0;
+    bool ok = false;
+    std::array<AliasSlot, kAliasSlots> slots{};
+};
+
+// false if key lands on a slot taken by a different alias
+constexpr bool placeAlias(AliasTable &t, std::string_view key, Category id) {
+    if (key.empty()) return true;
+    auto &slot = t.slots[aliasHash(key, t.seed) & (kAliasSlots - 1)];
+    if (slot.key.empty()) { slot.key = key; slot.id = id; return true; }
+    return slot.id == id && equalsFolded(slot.key, key);
+}
+
+constexpr bool tryAliasSeed(AliasTable &t) {
+    for (const auto &info : kCategories) {
+        if (!placeAlias(t, info.name, info.id)) return false;
+        for (const auto &a : info.aliases)
+            if (!placeAlias(t, a, info.id)) return false;
+    }
+    return true;
+}
+
+// search seeds until every alias gets its own slot (perfect hash)
+constexpr AliasTable buildAliasTable() {
+    for (std::uint32_t seed = 0; seed < 4096; ++seed) {
+        AliasTable t{};
+        t.seed = seed;
+        if (tryAliasSeed(t)) { t.ok = true; return t; }
+    }
+    return AliasTable{};
+}
+
+constexpr AliasTable kAliasTable = buildAliasTable();
+static_assert(kAliasTable.ok, "category aliases collide for every seed; grow kAliasSlots");
+
+} // namespace detail
+
+// single probe into the perfect hash; Category::Unknown if the name is not registered
+inline Category findCategory(std::string_view s) {
+    const auto &slot = detail::kAliasTable.slots[detail::aliasHash(s, detail::kAliasTable.seed) & (detail::kAliasSlots - 1)];
+    return detail::equalsFolded(slot.key, s) ? slot.id : Category::Unknown;
+}
+
+constexpr std::size_t categoryIndex(Category c) { return static_cast<std::size_t>(c); }
+
+constexpr std::string_view categoryName(Category c) {
+    return c == Category::Unknown ? std::string_view() : kCategories[categoryIndex(c)].name;
+}
+
+// normalize JSON/user category spellings to internal names; unknown names are
+// lowercased and capitalized as before
+inline std::string normalizeCategory(std::string_view cat) {
+    Category c = findCategory(cat);
+    if (c != Category::Unknown) return std::string(categoryName(c));
+    std::string low(cat);
+    for (auto &ch : low) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    if (!low.empty()) low[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(low[0])));
+    return low;
+}
+
+} // namespace menu
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef COMPACT_CATALOG_HPP
+#define COMPACT_CATALOG_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "AllocTracker.hpp"
+#include "Catalog.hpp"
+#include "Taste.hpp"
+
+namespace menu {
+
+// ========== QUANTIZED TASTE ==========
+// Taste values live in [0,1], so each dimension is stored as 8- or 16-bit
+// fixed point: q = round(x * max), x' = q / max. Out-of-range inputs are
+// clamped. Every dequantized dimension is within kTolerance of the clamped
+// original, which bounds the kernels below:
+//   |distance' - distance| <= sqrt(kTasteDims) * kTolerance   (5-D: 8-bit 0.0044, 16-bit 1.7e-5)
+//   |dot' - dot|           <= sum|w| * kTolerance
+template <class Q>
+struct TasteQuantizer {
+    static_assert(std::is_unsigned<Q>::value && sizeof(Q) <= 2, "taste storage must be uint8_t or uint16_t");
+    static constexpr double kMax = static_cast<double>(std::numeric_limits<Q>::max());
+    static constexpr double kStep = 1.0 / kMax;
+    static constexpr double kTolerance = 0.5 / kMax;
+
+    static Q encode(double x) {
+        x = std::min(1.0, std::max(0.0, x));
+        return static_cast<Q>(x * kMax + 0.5);
+    }
+    static double decode(Q q) { return q * kStep; }
+};
+
+// ========== COMPACT CATALOG ==========
+// The catalog in flat arrays, grouped by catalog key (same order as the map),
+// built once from a loaded Catalog, which can then be dropped: names in one
+// pooled string, exact prices and tastes as doubles, a veg byte, and the
+// quantized tastes the suggestion scans read. Only the scan is approximate:
+// served items are built from the exact arrays, so names, prices and tastes
+// reach the diner (and the model) at full precision. About 58 bytes plus the
+// name per item at 8 bits / 5-D, against several hundred for the JSON tree.
+template <class Q>
+class CompactCatalog : public CatalogView {
+public:
+    static constexpr std::size_t kDims = kTasteDims;
+    using Quantizer = TasteQuantizer<Q>;
+
+    struct Group {
+        std::string key;
+        Category id;
+        std::uint32_t begin, end; // item index range
+    };
+
+    explicit CompactCatalog(const Catalog &catalog) {
+        std::size_t n = 0, chars = 0;
+        for (auto &kv : catalog) {
+            n += kv.second.size();
+            for (const json &it : kv.second) chars += it.value("name", std::string()).size();
+        }
+        tastes.reserve(n * kDims);
+        exact.reserve(n * kDims);
+        prices.reserve(n);
+        flags.reserve(n);
+        nameEnd.reserve(n);
+        names.reserve(chars);
+        for (auto &kv : catalog) {
+            Group g{kv.first, findCategory(kv.first), static_cast<std::uint32_t>(prices.size()), 0};
+            for (const json &it : kv.second) {
+                Taste t = parseTasteFromJson(it);
+                for (std::size_t i = 0; i < kDims; ++i) {
+                    tastes.push_back(Quantizer::encode(t[i]));
+                    exact.push_back(t[i]);
+                }
+                prices.push_back(it.value("price", 0.0));
+                auto flag = it.find("vegetarian");
+                flags.push_back(static_cast<std::uint8_t>((isVegetarianEntry(it) ? kVeg : 0) |
+                                                          (flag != it.end() && flag->is_boolean() ? kVegFlagged : 0)));
+                names += it.value("name", std::string());
+                nameEnd.push_back(static_cast<std::uint32_t>(names.size()));
+            }
+            g.end = static_cast<std::uint32_t>(prices.size());
+            groups.push_back(g);
+        }
+    }
+
+    const std::vector<Group> &getGroups() const { return groups; }
+    std::size_t size() const { return prices.size(); }
+    bool isVegetarian(std::size_t idx) const { return (flags[idx] & kVeg) != 0; }
+    // dequantized; for scoring only, served items use the exact taste
+    Taste getTaste(std::size_t idx) const {
+        Taste t;
+        for (std::size_t i = 0; i < kDims; ++i) t[i] = Quantizer::decode(tastes[idx * kDims + i]);
+        return t;
+    }
+
+    // squared euclidean distance between a (float) profile and a dequantized item
+    double distance2(std::size_t idx, const double *profile) const {
+        const Q *q = &tastes[idx * kDims];
+        return sumOver<kDims>([&](auto i) { double d = profile[i] - q[i] * Quantizer::kStep; return d*d; });
+    }
+
+    // w . taste over the taste dimensions (w points at w1..wN, no bias)
+    double dot(std::size_t idx, const double *w) const {
+        const Q *q = &tastes[idx * kDims];
+        return sumOver<kDims>([&](auto i) { return w[i] * q[i]; }) * Quantizer::kStep;
+    }
+
+    // nearest item of group g to profile, optionally vegetarian only; -1 if nothing qualifies
+    long nearest(const Group &g, const double *profile, bool vegOnly) const {
+        long best = -1;
+        double bestDist = std::numeric_limits<double>::max();
+        for (std::uint32_t i = g.begin; i < g.end; ++i) {
+            if (vegOnly && !isVegetarian(i)) continue;
+            double d = distance2(i, profile);
+            if (d < bestDist) { bestDist = d; best = static_cast<long>(i); }
+        }
+        return best;
+    }
+
+    std::shared_ptr<MenuItem> makeItem(const Group &g, std::size_t idx) const {
+        AllocPhaseScope phase(AllocPhase::MakeItem);
+        return menu::makeItem(g.id, getName(idx), prices[idx], exactTaste(idx), isVegetarian(idx));
+    }
+
+    // CatalogView
+    std::size_t itemCount() const override { return size(); }
+    std::pair<std::size_t, std::size_t> groupRange(const std::string &key) const override {
+        for (auto &g : groups)
+            if (g.key == key) return {g.begin, g.end};
+        return {0, 0};
+    }
+    CatalogItem item(std::size_t idx) const override {
+        return {groupOf(idx).id, getName(idx), prices[idx], exactTaste(idx), isVegetarian(idx), (flags[idx] & kVegFlagged) != 0};
+    }
+    std::shared_ptr<MenuItem> makeItem(std::size_t idx) const override { return makeItem(groupOf(idx), idx); }
+
+    // everything the store holds
+    std::size_t memoryBytes() const {
+        std::size_t b = sizeof(*this);
+        b += tastes.capacity() * sizeof(Q) + exact.capacity() * sizeof(double) + prices.capacity() * sizeof(double);
+        b += flags.capacity() + nameEnd.capacity() * sizeof(std::uint32_t) + names.capacity();
+        b += groups.capacity() * sizeof(Group);
+        for (auto &g : groups) b += g.key.capacity();
+        return b;
+    }
+
+private:
+    static constexpr std::uint8_t kVeg = 1, kVegFlagged = 2;
+
+    std::vector<Group> groups;
+    std::vector<Q> tastes;               // kDims per item, quantized for the scans
+    std::vector<double> exact;           // kDims per item, as loaded
+    std::vector<double> prices;
+    std::vector<std::uint8_t> flags;     // kVeg | kVegFlagged
+    std::vector<std::uint32_t> nameEnd;  // item i's name is names[nameEnd[i-1], nameEnd[i])
+    std::string names;
+
+    std::string getName(std::size_t idx) const {
+        std::size_t begin = idx ? nameEnd[idx - 1] : 0;
+        return names.substr(begin, nameEnd[idx] - begin);
+    }
+    Taste exactTaste(std::size_t idx) const {
+        Taste t;
+        std::copy(exact.begin() + static_cast<std::ptrdiff_t>(idx * kDims),
+                  exact.begin() + static_cast<std::ptrdiff_t>((idx + 1) * kDims), t.begin());
+        return t;
+    }
+    const Group &groupOf(std::size_t idx) const {
+        auto g = std::upper_bound(groups.begin(), groups.end(), idx,
+                                  [](std::size_t i, const Group &gr) { return i < gr.end; });
+        return *g;
+    }
+};
+
+using CompactCatalog8 = CompactCatalog<std::uint8_t>;
+using CompactCatalog16 = CompactCatalog<std::uint16_t>;
+
+} // namespace menu
+
+#endif
@@ -0,0 +1,303 @@
+#include "LoadGen.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "AI.hpp"
+#include "AllocTracker.hpp"
+#include "ModelSelect.hpp"
+#include "Shadow.hpp"
+#include "Serializer.hpp"
+#include "Suggest.hpp"
+
+using namespace std;
+
+namespace menu {
+
+bool parseLoadGenArg(const string &arg, LoadGenConfig &cfg) {
+    auto val = [&](const char *flag, string &out) {
+        size_t n = char_traits<char>::length(flag);
+        if (arg.compare(0, n, flag) != 0) return false;
+        out = arg.substr(n);
+        return true;
+    };
+    string v;
+    if (val("--qps=", v)) cfg.qps = atof(v.c_str());
+    else if (val("--threads=", v)) cfg.threads = max(1, atoi(v.c_str()));
+    else if (val("--duration=", v)) cfg.seconds = atof(v.c_str());
+    else if (val("--report-every=", v)) cfg.reportEvery = max(0.1, atof(v.c_str()));
+    else if (val("--taste-dist=", v)) cfg.tasteDist = v;
+    else if (val("--taste-mean=", v)) cfg.tasteMean = atof(v.c_str());
+    else if (val("--taste-stddev=", v)) cfg.tasteStddev = atof(v.c_str());
+    else if (val("--veg-ratio=", v)) cfg.vegRatio = atof(v.c_str());
+    else if (val("--random-share=", v)) cfg.randomShare = atof(v.c_str());
+    else if (val("--rate-share=", v)) cfg.rateShare = atof(v.c_str());
+    else if (val("--rating-noise=", v)) cfg.ratingNoise = atof(v.c_str());
+    else if (val("--samples=", v)) cfg.samples = max(1, atoi(v.c_str()));
+    else if (val("--seed=", v)) cfg.seed = strtoull(v.c_str(), nullptr, 10);
+    else if (val("--record-feedback=", v)) cfg.feedbackFile = v;
+    else return false;
+    return true;
+}
+
+namespace {
+
+using Clock = chrono::steady_clock;
+using Truth = array<double, kTasteDims + 1>; // hidden [bias, w1..wN]
+
+double truthScore(const Truth &w, const Taste &t) { return w[0] + dot<kTasteDims>(&w[1], t.data()); }
+
+// latencies (microseconds) of one client, drained by the reporter every interval;
+// allocation counters are owned by the client and read after it is joined
+struct ClientStats {
+    mutex m;
+    vector<double> window;
+    AllocStats alloc;
+    uint64_t requests = 0, overBudget = 0;
+};
+
+// nearest-rank percentile; reorders v
+double percentile(vector<double> &v, double p) {
+    if (v.empty()) return 0;
+    size_t k = min(v.size() - 1, static_cast<size_t>(p * v.size()));
+    nth_element(v.begin(), v.begin() + static_cast<ptrdiff_t>(k), v.end());
+    return v[k];
+}
+
+void printRow(const string &label, vector<double> &lat, double seconds, double rmse) {
+    cout << setw(8) << label << setw(10) << lat.size() << setw(12) << setprecision(1) << (seconds > 0 ? lat.size() / seconds : 0.0)
+         << setw(10) << setprecision(1) << percentile(lat, 0.50) << setw(10) << percentile(lat, 0.99)
+         << setw(10) << percentile(lat, 0.999) << setw(12) << setprecision(5) << rmse << "\n";
+}
+
+} // namespace
+
+int runLoadGen(const LoadGenConfig &cfg, const LoadGenCatalog &source) {
+    ShardedCatalog *sharded = source.sharded;
+    size_t items = source.compact8 ? source.compact8->size() : source.compact16 ? source.compact16->size() : 0;
+    if (source.catalog) for (auto &kv : *source.catalog) items += kv.second.size();
+    if (sharded) items += sharded->itemCount();
+    if (items == 0) { cerr << "Load generator: catalog is empty\n"; return 1; }
+    // Random+AI samples the whole catalog, which only the shards hold
+    double randomShare = cfg.randomShare;
+    if (sharded && randomShare > 0) {
+        cerr << "Warning: Random+AI needs the whole catalog; with --shards every request is a taste-profile query\n";
+        randomShare = 0;
+    }
+    if (cfg.tasteDist != "normal" && cfg.tasteDist != "uniform") { cerr << "Unknown --taste-dist=" << cfg.tasteDist << "\n"; return 1; }
+
+    mt19937_64 master(cfg.seed);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // hidden ground truth, and a fixed probe set to measure how close the live model gets
+    Truth truth;
+    truth[0] = unit(master) * 0.4;
+    for (size_t i = 1; i < truth.size(); ++i) truth[i] = unit(master) * 0.6 - 0.1;
+    vector<Taste> probes(256);
+    for (auto &p : probes) for (auto &x : p) x = unit(master);
+
+    ai::LinearRegression model(0.01); // starts from defaults; weights.json is neither read nor written
+    mutex modelMutex;
+    mutex shardMutex; // the sharded coordinator serves one query at a time
+    // shadows: each client keeps its own copy of the matrix and refreshes the primary column per request
+    ai::ModelSet shadowProto(model);
+    for (auto &f : cfg.shadowFiles) shadowProto.addFromFile(f);
+    unique_ptr<ai::ShadowLog> shadowLog;
+    if (shadowProto.size() > 1) {
+        shadowLog = make_unique<ai::ShadowLog>(cfg.shadowLog);
+        if (!shadowLog->isOpen()) return 1;
+    }
+    atomic<uint64_t> nextRequest{0};
+    double kernelNs = 0; // one fused scoring call, all models
+    if (shadowLog) {
+        vector<double> out(shadowProto.size());
+        Taste x = neutralTaste();
+        const int reps = 200000;
+        auto k0 = Clock::now();
+        for (int i = 0; i < reps; ++i) { x[static_cast<size_t>(i) % kTasteDims] += 1e-9; shadowProto.scoreAll(x.data(), out.data()); }
+        kernelNs = chrono::duration<double, nano>(Clock::now() - k0).count() / reps;
+    }
+    ofstream feedback; // guarded by modelMutex, like the training it records
+    if (!cfg.feedbackFile.empty()) {
+        feedback.open(cfg.feedbackFile, ios::app);
+        if (!feedback.is_open()) { cerr << "Could not open " << cfg.feedbackFile << " to record feedback\n"; return 1; }
+    }
+    auto modelRmse = [&]() {
+        ai::LinearRegression snap = [&] { lock_guard<mutex> lock(modelMutex); return model; }();
+        double s = 0;
+        for (auto &p : probes) { double d = snap.predict(p) - truthScore(truth, p); s += d*d; }
+        return sqrt(s / probes.size());
+    };
+
+    vector<ClientStats> stats(static_cast<size_t>(cfg.threads));
+    atomic<uint64_t> nextArrival{0};
+    atomic<bool> failed{false};
+    const auto start = Clock::now();
+    const auto end = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(cfg.seconds));
+
+    auto client = [&](int id) {
+        mt19937_64 rng(cfg.seed * 7919 + static_cast<uint64_t>(id) + 1);
+        normal_distribution<double> normal(cfg.tasteMean, cfg.tasteStddev);
+        uniform_real_distribution<double> u01(0.0, 1.0);
+        normal_distribution<double> noise(0.0, cfg.ratingNoise);
+        auto &st = stats[static_cast<size_t>(id)];
+        ai::ModelSet shadows = shadowProto;
+        ai::ShadowRecord shadowRec;
+        while (true) {
+            // open loop: latency counts from the scheduled arrival, so queueing behind slow requests shows up
+            Clock::time_point t0;
+            if (cfg.qps > 0) {
+                uint64_t n = nextArrival++;
+                t0 = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(n / cfg.qps));
+                if (t0 >= end) break;
+                this_thread::sleep_until(t0);
+            } else {
+                t0 = Clock::now();
+                if (t0 >= end) break;
+            }
+
+            Taste profile;
+            for (auto &x : profile) {
+                x = cfg.tasteDist == "uniform" ? u01(rng) : normal(rng);
+                x = min(1.0, max(0.0, x));
+            }
+            bool preferVeg = u01(rng) < cfg.vegRatio;
+            ai::LinearRegression snap = [&] { lock_guard<mutex> lock(modelMutex); return model; }();
+
+            {
+                // the tracked request ends before its latency is recorded
+                AllocRequest request(cfg.allocBudget);
+                vector<shared_ptr<MenuItem>> sug;
+                bool random = u01(rng) < randomShare;
+                try {
+                    // everything that allocates for this request stays inside the try, so a
+                    // budget overrun is counted here instead of escaping the client thread
+                    if (shadowLog) shadows.setPrimary(snap);
+                    auto randomMenu = [&](const auto &catalog) {
+                        return shadowLog ? suggestRandomMenuBest(catalog, shadows, preferVeg, cfg.samples, shadowRec)
+                                         : suggestRandomMenuBest(catalog, snap, preferVeg, cfg.samples);
+                    };
+                    auto profileMenu = [&](const auto &catalog) { return suggestByTasteProfile(catalog, profile, preferVeg); };
+                    if (random) sug = source.compact8 ? randomMenu(*source.compact8)
+                                    : source.compact16 ? randomMenu(*source.compact16) : randomMenu(*source.catalog);
+                    else if (sharded) { lock_guard<mutex> lock(shardMutex); sug = sharded->suggestByTasteProfile(profile, preferVeg); }
+                    else sug = source.compact8 ? profileMenu(*source.compact8)
+                             : source.compact16 ? profileMenu(*source.compact16) : profileMenu(*source.catalog);
+
+                    uint64_t requestId = 0;
+                    if (shadowLog && !sug.empty()) {
+                        if (!random) {
+                            shadowRec.served.resize(shadows.size());
+                            shadowRec.best.clear();
+                            shadows.scoreAll(tasteVectorFromMenu(sug).data(), shadowRec.served.data());
+                        }
+                        requestId = ++nextRequest;
+                        string &out = outputBuffer();
+                        ai::writeShadowRecord(out, requestId, random ? "random" : "profile", shadowRec, shadows);
+                        shadowLog->write(out);
+                    }
+
+                    if (!sug.empty() && u01(rng) < cfg.rateShare) {
+                        Taste taste = tasteVectorFromMenu(sug);
+                        double rating = min(1.0, max(0.0, truthScore(truth, taste) + noise(rng)));
+                        if (requestId) {
+                            string &out = outputBuffer();
+                            ai::writeShadowRating(out, requestId, rating);
+                            shadowLog->write(out);
+                        }
+                        // the feedback line is built before training, so a rejected request leaves neither
+                        string &out = outputBuffer();
+                        if (feedback.is_open()) ai::writeFeedback(out, taste, rating);
+                        lock_guard<mutex> lock(modelMutex);
+                        model.train(taste, rating);
+                        if (feedback.is_open()) flushOutput(out, feedback);
+                    }
+                } catch (const AllocBudgetExceeded &) {
+                    sug.clear(); // rejected: answered, but not rated
+                    ++st.overBudget;
+                } catch (const std::exception &e) {
+                    if (!failed.exchange(true)) cerr << "Load generator request failed: " << e.what() << "\n";
+                    break;
+                }
+                st.alloc += request.stats();
+                ++st.requests;
+            }
+
+            double us = chrono::duration<double, micro>(Clock::now() - t0).count();
+            lock_guard<mutex> lock(st.m);
+            st.window.push_back(us);
+        }
+    };
+
+    cout << "Load generator: " << cfg.threads << " clients, "
+         << (cfg.qps > 0 ? "open loop at " + to_string(cfg.qps) + " req/s" : string("closed loop"))
+         << ", " << cfg.seconds << " s, taste " << cfg.tasteDist << ", veg ratio " << cfg.vegRatio << "\n";
+    cout << fixed << setw(8) << "t(s)" << setw(10) << "requests" << setw(12) << "req/s"
+         << setw(10) << "p50(us)" << setw(10) << "p99(us)" << setw(10) << "p999(us)" << setw(12) << "model rmse" << "\n";
+
+    vector<thread> clients;
+    for (int i = 0; i < cfg.threads; ++i) clients.emplace_back(client, i);
+
+    // interval reports until every client has finished
+    vector<double> all, window;
+    auto last = start;
+    auto drain = [&]() {
+        window.clear();
+        for (auto &st : stats) {
+            lock_guard<mutex> lock(st.m);
+            window.insert(window.end(), st.window.begin(), st.window.end());
+            st.window.clear();
+        }
+        all.insert(all.end(), window.begin(), window.end());
+    };
+    auto step = chrono::duration_cast<Clock::duration>(chrono::duration<double>(cfg.reportEvery));
+    while (Clock::now() < end) {
+        this_thread::sleep_until(min(end, last + step));
+        auto now = Clock::now();
+        drain();
+        printRow(to_string(static_cast<int>(chrono::duration<double>(now - start).count() + 0.5)), window,
+                 chrono::duration<double>(now - last).count(), modelRmse());
+        last = now;
+    }
+    for (auto &t : clients) t.join();
+    drain();
+
+    double total = chrono::duration<double>(Clock::now() - start).count();
+    printRow("total", all, total, modelRmse());
+    if (cfg.allocReport || cfg.allocBudget) {
+        AllocStats alloc;
+        uint64_t requests = 0, overBudget = 0;
+        for (auto &st : stats) { alloc += st.alloc; requests += st.requests; overBudget += st.overBudget; }
+        alloc.overBudget = false; // reported as a count below
+        string &out = outputBuffer();
+        out += "Allocations per request: ";
+        writeAllocReport(out, alloc, static_cast<double>(max<uint64_t>(1, requests)));
+        out += '\n';
+        if (cfg.allocBudget && kAllocTracking) {
+            out += "Over budget: ";
+            appendNumber(out, static_cast<size_t>(overBudget));
+            out += " of ";
+            appendNumber(out, static_cast<size_t>(requests));
+            out += " requests\n";
+        }
+        flushOutput(out);
+    }
+    if (shadowLog) {
+        auto precision = cout.precision(1);
+        cout << "Shadow models: " << shadowProto.size() - 1 << ", fused scoring " << kernelNs
+             << " ns per candidate (" << kernelNs * cfg.samples / 1000 << " us per Random+AI request), "
+             << nextRequest.load() << " requests logged to " << cfg.shadowLog << ", " << shadowLog->dropped() << " writes dropped\n";
+        cout.precision(precision); // printWeights below uses the stream's precision
+    }
+    model.printWeights();
+    return failed ? 1 : 0;
+}
+
+} // namespace menu
@@ -0,0 +1,58 @@
+#ifndef LOADGEN_HPP
+#define LOADGEN_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Catalog.hpp"
+#include "CompactCatalog.hpp"
+#include "Shard.hpp"
+
+namespace menu {
+
+// ========== LOAD GENERATOR ==========
+// Synthesizes diners and pushes them through the suggestion and training
+// paths in-process, or through the sharded coordinator when one is given.
+// Each diner has a taste profile drawn from a normal or uniform
+// distribution and a vegetarian preference. Ratings come from a hidden
+// ground-truth linear model plus noise. The live model starts from its
+// defaults, so its convergence toward the hidden one can be tracked.
+struct LoadGenConfig {
+    double qps = 0;                // target arrival rate; 0 = closed loop
+    int threads = 4;               // concurrent clients
+    double seconds = 10;           // run length
+    double reportEvery = 1;        // seconds between interval reports
+    std::string tasteDist = "normal"; // normal | uniform
+    double tasteMean = 0.5;
+    double tasteStddev = 0.2;
+    double vegRatio = 0.3;         // share of diners who prefer a vegetarian main
+    double randomShare = 0.5;      // share of requests using Random+AI (rest: taste profile)
+    double rateShare = 1.0;        // share of suggestions that get rated and trained on
+    double ratingNoise = 0.05;     // stddev of noise on the hidden model's rating
+    int samples = 40;              // Random+AI candidate menus per request
+    std::uint64_t seed = 1;
+    std::string feedbackFile;      // appends every rating trained on (for --select-model); empty = off
+    std::vector<std::string> shadowFiles; // shadow models scored next to the live one (--shadow=)
+    std::string shadowLog = "shadow_log.jsonl";
+    bool allocReport = false;      // per-request allocation profile at the end (MENU_ALLOC_TRACKING builds)
+    std::uint64_t allocBudget = 0; // per-request allocation budget in bytes; 0 = none
+};
+
+// what the requests are served from: the JSON catalog or the compact one that
+// replaces it (--quantized), or the shards (--shards), which then take every request
+struct LoadGenCatalog {
+    const Catalog *catalog = nullptr;
+    const CompactCatalog8 *compact8 = nullptr;
+    const CompactCatalog16 *compact16 = nullptr;
+    ShardedCatalog *sharded = nullptr;
+};
+
+// consumes one load generator flag (--qps=, --threads=, --duration=, ...); false if arg is not one
+bool parseLoadGenArg(const std::string &arg, LoadGenConfig &cfg);
+
+// runs the load and prints the report to stdout; returns a process exit code
+int runLoadGen(const LoadGenConfig &cfg, const LoadGenCatalog &source);
+
+} // namespace menu
+
+#endif
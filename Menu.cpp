@@ -1,4 +1,7 @@
 #include "Menu.hpp"
+#include "Catalog.hpp"
+#include "Serializer.hpp"
+#include "AllocTracker.hpp"
 #include <iostream>
 #include <algorithm>
 #include <numeric>
@@ -11,65 +14,98 @@ namespace menu {
 
 // ========== BASE ==========
 
-MenuItem::MenuItem(const std::string &n, double p, const std::vector<double> &t)
-    : name(n), price(p), taste(t) {
-    if (taste.size() != 5) taste = std::vector<double>(5, 0.5);
-}
+MenuItem::MenuItem(const std::string &n, double p, const Taste &t)
+    : name(n), price(p), taste(t) {}
 
 string MenuItem::getName() const { return name; }
 double MenuItem::getPrice() const { return price; }
-std::vector<double> MenuItem::getTaste() const { return taste; }
+const Taste &MenuItem::getTaste() const { return taste; }
 double MenuItem::getTasteAvg() const {
-    if (taste.empty()) return 0.5;
-    double s = accumulate(taste.begin(), taste.end(), 0.0);
-    return s / taste.size();
+    double s = sumOver<kTasteDims>([&](auto i) { return taste[i]; });
+    return s / kTasteDims;
+}
+
+void MenuItem::printInfo() const {
+    string &out = outputBuffer();
+    writeInfo(out);
+    flushOutput(out);
+}
+
+void MenuItem::writeJson(string &out) const {
+    out += "{\"category\":\"";
+    out += categoryName(getCategory());
+    out += "\",\"name\":";
+    appendJsonString(out, name);
+    out += ",\"price\":";
+    appendJsonNumber(out, price);
+    out += ",\"taste\":[";
+    for (size_t i = 0; i < kTasteDims; ++i) { if (i) out += ','; appendJsonNumber(out, taste[i]); }
+    out += ']';
+    writeJsonOptions(out);
+    out += '}';
 }
 
 void MenuItem::setName(const string &n) { name = n; }
 void MenuItem::setPrice(double p) { price = p; }
-void MenuItem::setTaste(const std::vector<double> &t) { taste = (t.size()==5? t : std::vector<double>(5,0.5)); }
+void MenuItem::setTaste(const Taste &t) { taste = t; }
 
 // ========== Starter ==========
-Starter::Starter(const std::string &n, double p, const std::vector<double> &t, bool hot)
+Starter::Starter(const std::string &n, double p, const Taste &t, bool hot)
     : MenuItem(n,p,t), isHot(hot) {}
-void Starter::printInfo() const {
-    cout << "[Starter] " << name << " - $" << price << " - taste(avg:" << getTasteAvg() << ") - " << (isHot ? "Hot" : "Cold") << "\n";
+void Starter::writeInfo(string &out) const {
+    out += "[Starter] "; out += name; out += " - $"; appendNumber(out, price);
+    out += " - taste(avg:"; appendNumber(out, getTasteAvg()); out += ") - "; out += (isHot ? "Hot\n" : "Cold\n");
 }
 void Starter::customize() {
     cout << "Starter - hot? (1=yes,0=no): ";
     int v; if (!(cin >> v)) { cin.clear(); cin.ignore(10000,'\n'); return; }
     isHot = (v==1);
 }
+Category Starter::getCategory() const { return Category::Starter; }
+uint8_t Starter::getOptions() const { return isHot ? 1 : 0; }
+void Starter::setOptions(uint8_t o) { isHot = (o & 1) != 0; }
+void Starter::writeJsonOptions(string &out) const { out += isHot ? ",\"hot\":true" : ",\"hot\":false"; }
 
 // ========== Salad ==========
-Salad::Salad(const std::string &n, double p, const std::vector<double> &t, bool topping)
+Salad::Salad(const std::string &n, double p, const Taste &t, bool topping)
     : MenuItem(n,p,t), hasTopping(topping) {}
-void Salad::printInfo() const {
-    cout << "[Salad] " << name << " - $" << price << (hasTopping ? " +topping" : "") << " - taste(avg:" << getTasteAvg() << ")\n";
+void Salad::writeInfo(string &out) const {
+    out += "[Salad] "; out += name; out += " - $"; appendNumber(out, price); if (hasTopping) out += " +topping";
+    out += " - taste(avg:"; appendNumber(out, getTasteAvg()); out += ")\n";
 }
 void Salad::customize() {
     cout << "Add topping +$2.25? (1=yes,0=no): ";
     int v; if (!(cin >> v)) { cin.clear(); cin.ignore(10000,'\n'); return; }
     if (v==1 && !hasTopping) { hasTopping=true; price += 2.25; }
 }
+Category Salad::getCategory() const { return Category::Salad; }
+uint8_t Salad::getOptions() const { return hasTopping ? 1 : 0; }
+void Salad::setOptions(uint8_t o) { hasTopping = (o & 1) != 0; }
+void Salad::writeJsonOptions(string &out) const { out += hasTopping ? ",\"topping\":true" : ",\"topping\":false"; }
 
 // ========== MainCourse ==========
-MainCourse::MainCourse(const std::string &n, double p, const std::vector<double> &t, bool veg)
+MainCourse::MainCourse(const std::string &n, double p, const Taste &t, bool veg)
     : MenuItem(n,p,t), isVegetarian(veg) {}
-void MainCourse::printInfo() const {
-    cout << "[Main] " << name << " - $" << price << " - " << (isVegetarian ? "Vegetarian" : "Non-veg") << " - taste(avg:" << getTasteAvg() << ")\n";
+void MainCourse::writeInfo(string &out) const {
+    out += "[Main] "; out += name; out += " - $"; appendNumber(out, price); out += (isVegetarian ? " - Vegetarian" : " - Non-veg");
+    out += " - taste(avg:"; appendNumber(out, getTasteAvg()); out += ")\n";
 }
 void MainCourse::customize() {
     cout << "Vegetarian? (1=yes,0=no): ";
     int v; if (!(cin >> v)) { cin.clear(); cin.ignore(10000,'\n'); return; }
     isVegetarian = (v==1);
 }
+Category MainCourse::getCategory() const { return Category::MainCourse; }
+uint8_t MainCourse::getOptions() const { return isVegetarian ? 1 : 0; }
+void MainCourse::setOptions(uint8_t o) { isVegetarian = (o & 1) != 0; }
+void MainCourse::writeJsonOptions(string &out) const { out += isVegetarian ? ",\"vegetarian\":true" : ",\"vegetarian\":false"; }
 
 // ========== Drink ==========
-Drink::Drink(const std::string &n, double p, const std::vector<double> &t, bool carb, bool shot)
+Drink::Drink(const std::string &n, double p, const Taste &t, bool carb, bool shot)
     : MenuItem(n,p,t), carbonated(carb), extraShot(shot) {}
-void Drink::printInfo() const {
-    cout << "[Drink] " << name << " - $" << price << (carbonated ? " +carbonation" : "") << (extraShot ? " +shot" : "") << " - taste(avg:" << getTasteAvg() << ")\n";
+void Drink::writeInfo(string &out) const {
+    out += "[Drink] "; out += name; out += " - $"; appendNumber(out, price); if (carbonated) out += " +carbonation"; if (extraShot) out += " +shot";
+    out += " - taste(avg:"; appendNumber(out, getTasteAvg()); out += ")\n";
 }
 void Drink::customize() {
     cout << "Carbonated +$0.5? (1=yes,0=no): ";
@@ -79,45 +115,77 @@ void Drink::customize() {
     if (!(cin >> v)) { cin.clear(); cin.ignore(10000,'\n'); return; }
     if (v==1 && !extraShot) { extraShot=true; price += 2.5; }
 }
+Category Drink::getCategory() const { return Category::Drink; }
+uint8_t Drink::getOptions() const { return static_cast<uint8_t>((carbonated ? 1 : 0) | (extraShot ? 2 : 0)); }
+void Drink::setOptions(uint8_t o) { carbonated = (o & 1) != 0; extraShot = (o & 2) != 0; }
+void Drink::writeJsonOptions(string &out) const { out += carbonated ? ",\"carbonated\":true" : ",\"carbonated\":false"; out += extraShot ? ",\"extraShot\":true" : ",\"extraShot\":false"; }
 
 // ========== Appetizer ==========
-Appetizer::Appetizer(const std::string &n, double p, const std::vector<double> &t, const std::string &serve)
+Appetizer::Appetizer(const std::string &n, double p, const Taste &t, const std::string &serve)
     : MenuItem(n,p,t), serveTime(serve) {}
-void Appetizer::printInfo() const {
-    cout << "[Appetizer] " << name << " - $" << price << " - serve: " << serveTime << " - taste(avg:" << getTasteAvg() << ")\n";
+void Appetizer::writeInfo(string &out) const {
+    out += "[Appetizer] "; out += name; out += " - $"; appendNumber(out, price); out += " - serve: "; out += serveTime;
+    out += " - taste(avg:"; appendNumber(out, getTasteAvg()); out += ")\n";
 }
 void Appetizer::customize() {
     cout << "Serve before main? (1=before,0=after): ";
     int v; if (!(cin >> v)) { cin.clear(); cin.ignore(10000,'\n'); return; }
     serveTime = (v==1 ? "before" : "after");
 }
+Category Appetizer::getCategory() const { return Category::Appetizer; }
+uint8_t Appetizer::getOptions() const { return serveTime == "after" ? 1 : 0; }
+void Appetizer::setOptions(uint8_t o) { serveTime = (o & 1) ? "after" : "before"; }
+void Appetizer::writeJsonOptions(string &out) const { out += ",\"serve\":"; appendJsonString(out, serveTime); }
 
 // ========== Dessert ==========
-Dessert::Dessert(const std::string &n, double p, const std::vector<double> &t, bool choc)
+Dessert::Dessert(const std::string &n, double p, const Taste &t, bool choc)
     : MenuItem(n,p,t), extraChocolate(choc) {}
-void Dessert::printInfo() const {
-    cout << "[Dessert] " << name << " - $" << price << (extraChocolate ? " +choc" : "") << " - taste(avg:" << getTasteAvg() << ")\n";
+void Dessert::writeInfo(string &out) const {
+    out += "[Dessert] "; out += name; out += " - $"; appendNumber(out, price); if (extraChocolate) out += " +choc";
+    out += " - taste(avg:"; appendNumber(out, getTasteAvg()); out += ")\n";
 }
 void Dessert::customize() {
     cout << "Add extra chocolate +$1.5? (1=yes,0=no): ";
     int v; if (!(cin >> v)) { cin.clear(); cin.ignore(10000,'\n'); return; }
     if (v==1 && !extraChocolate) { extraChocolate=true; price += 1.5; }
 }
+Category Dessert::getCategory() const { return Category::Dessert; }
+uint8_t Dessert::getOptions() const { return extraChocolate ? 1 : 0; }
+void Dessert::setOptions(uint8_t o) { extraChocolate = (o & 1) != 0; }
+void Dessert::writeJsonOptions(string &out) const { out += extraChocolate ? ",\"extraChocolate\":true" : ",\"extraChocolate\":false"; }
+
+// ========== FACTORY ==========
+using ItemFactory = shared_ptr<MenuItem> (*)(const string &, double, const Taste &, bool);
+
+template <class T>
+static shared_ptr<MenuItem> makeOf(const string &n, double p, const Taste &t, bool) { return make_shared<T>(n,p,t); }
+template <>
+shared_ptr<MenuItem> makeOf<MainCourse>(const string &n, double p, const Taste &t, bool veg) { return make_shared<MainCourse>(n,p,t,veg); }
+
+// indexed by Category; the trailing entry is the Unknown fallback
+static constexpr ItemFactory kItemFactories[kCategoryCount + 1] = {
+#define MENU_CATEGORY_FACTORY(cls, ...) &makeOf<cls>,
+    MENU_CATEGORIES(MENU_CATEGORY_FACTORY)
+#undef MENU_CATEGORY_FACTORY
+    &makeOf<Starter>
+};
+
+shared_ptr<MenuItem> makeItem(Category c, const string &n, double p, const Taste &t, bool veg) {
+    AllocPhaseScope phase(AllocPhase::MakeItem);
+    return kItemFactories[categoryIndex(c)](n, p, t, veg);
+}
 
 // ========== MENU ==========
-Menu::Menu() : totalCost(0.0), tasteAvg(5,0.5) {}
+Menu::Menu() : totalCost(0.0), tasteAvg(neutralTaste()) {}
 
 void Menu::addItem(shared_ptr<MenuItem> item) {
     if (!item) return;
     items.push_back(item);
     totalCost += item->getPrice();
     // recompute tasteAvg
-    vector<double> sum(5,0.0);
-    for (auto &it : items) {
-        auto t = it->getTaste();
-        for (size_t i=0;i<5;++i) sum[i] += t[i];
-    }
-    for (size_t i=0;i<5;++i) tasteAvg[i] = sum[i] / items.size();
+    Taste sum{};
+    for (auto &it : items) addTaste(sum, it->getTaste());
+    for (size_t i=0;i<kTasteDims;++i) tasteAvg[i] = sum[i] / items.size();
 }
 
 void Menu::removeItem(const string &name) {
@@ -126,11 +194,11 @@ void Menu::removeItem(const string &name) {
         totalCost -= (*it)->getPrice();
         items.erase(it);
         // recompute tasteAvg
-        if (items.empty()) tasteAvg = vector<double>(5,0.5);
+        if (items.empty()) tasteAvg = neutralTaste();
         else {
-            vector<double> sum(5,0.0);
-            for (auto &it2 : items) { auto t = it2->getTaste(); for (size_t k=0;k<5;++k) sum[k]+=t[k]; }
-            for (size_t k=0;k<5;++k) tasteAvg[k] = sum[k] / items.size();
+            Taste sum{};
+            for (auto &it2 : items) addTaste(sum, it2->getTaste());
+            for (size_t k=0;k<kTasteDims;++k) tasteAvg[k] = sum[k] / items.size();
         }
     } else cout << "Item to remove not found: " << name << "\n";
 }
@@ -141,9 +209,9 @@ void Menu::updateItem(const string &name) {
         (*it)->customize();
         // recompute cost/taste
         totalCost = 0;
-        vector<double> sum(5,0.0);
-        for (auto &it2 : items) { totalCost += it2->getPrice(); auto t = it2->getTaste(); for (size_t k=0;k<5;++k) sum[k]+=t[k]; }
-        for (size_t k=0;k<5;++k) tasteAvg[k] = items.empty()?0.5: sum[k] / items.size();
+        Taste sum{};
+        for (auto &it2 : items) { totalCost += it2->getPrice(); addTaste(sum, it2->getTaste()); }
+        for (size_t k=0;k<kTasteDims;++k) tasteAvg[k] = items.empty()?0.5: sum[k] / items.size();
     } else cout << "Item to update not found: " << name << "\n";
 }
 
@@ -152,21 +220,27 @@ void Menu::showMenu() const {
         cout << "-- Your menu is empty --\n";
         return;
     }
-    cout << "-- Your Menu --\n";
+    string &out = outputBuffer();
+    out += "-- Your Menu --\n";
     for (size_t i = 0; i < items.size(); ++i) {
-        cout << i + 1 << ". ";
-        items[i]->printInfo();
+        appendNumber(out, i + 1);
+        out += ". ";
+        items[i]->writeInfo(out);
     }
-    cout << "Total cost: $" << totalCost << " | Taste avg: [";
+    out += "Total cost: $";
+    appendNumber(out, totalCost);
+    out += " | Taste avg: [";
     for (size_t i = 0; i < tasteAvg.size(); ++i) {
-        cout << tasteAvg[i];
-        if (i + 1 < tasteAvg.size()) cout << ", ";
+        appendNumber(out, tasteAvg[i]);
+        if (i + 1 < tasteAvg.size()) out += ", ";
     }
-    cout << "]\n";
+    out += "]\n";
+    flushOutput(out);
 }
 
 double Menu::getTotalCost() const { return totalCost; }
-std::vector<double> Menu::getTasteAvg() const { return tasteAvg; }
+const Taste &Menu::getTasteAvg() const { return tasteAvg; }
+const std::vector<std::shared_ptr<MenuItem>> &Menu::getItems() const { return items; }
 
 // ========== USER ==========
 User::User(const std::string &f, const std::string &l, const std::string &g)
@@ -182,70 +256,13 @@ void User::showInfo() const {
 }
 
 Menu &User::getMenu() { return userMenu; }
-
-// helper: normalizeCategory (keeps Menu.cpp independent)
-static std::string normalizeCategory(const std::string &cat) {
-    std::string low = cat;
-    for (auto &c : low) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-    if (low == "starters" || low == "starter") return "Starter";
-    if (low == "salads" || low == "salad") return "Salad";
-    if (low == "main_courses" || low == "main_course" || low == "maincourse" || low == "maincourses") return "MainCourse";
-    if (low == "drinks" || low == "drink") return "Drink";
-    if (low == "appetizers" || low == "appetizer") return "Appetizer";
-    if (low == "desserts" || low == "dessert") return "Dessert";
-    if (!low.empty()) { low[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(low[0]))); return low; }
-    return cat;
-}
-
-// helper: parse taste helper (handles object with named keys, arrays, or taste_balance)
-static std::vector<double> parseTasteFromJson(const json &it) {
-    std::vector<double> t(5, 0.5); // order: sweet, salty, sour, bitter, spicy/savory
-    if (it.contains("taste")) {
-        if (it["taste"].is_array()) {
-            size_t idx = 0;
-            for (auto &v : it["taste"]) if (idx < 5) t[idx++] = v.get<double>();
-            return t;
-        }
-        if (it["taste"].is_object()) {
-            auto &tb = it["taste"];
-            auto getv = [&](const std::string &k)->double {
-                // use value(key, default) to avoid template parsing issues and simplify
-                if (tb.contains(k) && tb[k].is_number()) return tb.value(k, 0.5);
-                return 0.5;
-            };
-            t[0] = getv("sweet");
-            t[1] = getv("salty");
-            t[2] = getv("sour");
-            t[3] = getv("bitter");
-            t[4] = tb.contains("spicy") ? getv("spicy") : getv("savory");
-            return t;
-        }
-    }
-    if (it.contains("taste_balance")) {
-        if (it["taste_balance"].is_number()) {
-            double tb = it["taste_balance"].get<double>();
-            return std::vector<double>(5, tb);
-        }
-        if (it["taste_balance"].is_object()) {
-            auto &tb = it["taste_balance"];
-            auto getv = [&](const std::string &k)->double {
-                if (tb.contains(k) && tb[k].is_number()) return tb.value(k, 0.5);
-                return 0.5;
-            };
-            t[0] = getv("sweet");
-            t[1] = getv("salty");
-            t[2] = getv("sour");
-            t[3] = getv("bitter");
-            t[4] = tb.contains("spicy") ? getv("spicy") : getv("savory");
-            return t;
-        }
-    }
-    return t;
-}
-
+const Menu &User::getMenu() const { return userMenu; }
+const string &User::getFirstName() const { return firstName; }
+const string &User::getLastName() const { return lastName; }
+const string &User::getGender() const { return gender; }
 
 // updated interact: accept catalog and list available items for chosen category
-void User::interact(const std::map<std::string, std::vector<json>> &catalog) {
+void User::interact(const CatalogView &catalog) {
     while(true) {
         cout << "\nOptions: 1=show 2=add 3=remove 4=update 0=exit\nChoice: ";
         int c; if (!(cin>>c)) { cin.clear(); cin.ignore(10000,'\n'); continue; }
@@ -254,36 +271,36 @@ void User::interact(const std::map<std::string, std::vector<json>> &catalog) {
         else if (c==2) {
             cout << "Category (Starter/Salad/MainCourse/Drink/Appetizer/Dessert): ";
             string cat; cin >> cat;
+            Category catId = findCategory(cat);
             cat = normalizeCategory(cat); // normalize user input so comparisons work
             cin.ignore();
 
             string name;
             double price = 0.0;
-            vector<double> t(5,0.5);
+            Taste t = neutralTaste();
 
             // If catalog has entries for this category, list them with prices
-            auto it = catalog.find(cat);
-            if (it != catalog.end() && !it->second.empty()) {
+            auto range = catalog.groupRange(cat);
+            size_t count = range.second - range.first;
+            if (count > 0) {
                 cout << "\nAvailable items in " << cat << ":\n";
-                for (size_t i = 0; i < it->second.size(); ++i) {
-                    string nm = it->second[i].value("name", string());
-                    double pr = it->second[i].value("price", 0.0);
-                    cout << " " << (i+1) << ") " << nm << " - $" << pr << "\n";
+                for (size_t i = 0; i < count; ++i) {
+                    CatalogItem ci = catalog.item(range.first + i);
+                    cout << " " << (i+1) << ") " << ci.name << " - $" << ci.price << "\n";
                 }
                 cout << "Enter number to prefill that item, or 0 to enter new: ";
                 int sel; if (!(cin >> sel)) { cin.clear(); cin.ignore(10000,'\n'); sel = 0; }
                 cin.ignore();
-                if (sel > 0 && static_cast<size_t>(sel) <= it->second.size()) {
-                    const json &selj = it->second[sel-1];
-                    name = selj.value("name", string());
-                    price = selj.value("price", 0.0);
-                    // parse taste in all supported shapes (object with keys, array, taste_balance)
-                    t = parseTasteFromJson(selj);
+                if (sel > 0 && static_cast<size_t>(sel) <= count) {
+                    CatalogItem ci = catalog.item(range.first + static_cast<size_t>(sel) - 1);
+                    name = ci.name;
+                    price = ci.price;
+                    t = ci.taste;
                 } else {
                     // manual entry
                     cout << "Name: "; getline(cin, name);
                     cout << "Price: "; cin >> price;
-                    cout << "Enter 5 taste numbers (sweet sour bitter salty savory): ";
+                    cout << "Enter " << kTasteDims << " taste numbers (" << tasteDimNames() << "): ";
                     for (auto &v: t) cin >> v;
                     cin.ignore();
                 }
@@ -291,40 +308,33 @@ void User::interact(const std::map<std::string, std::vector<json>> &catalog) {
                 // no catalog entry -> manual entry
                 cout << "Name: "; getline(cin, name);
                 cout << "Price: "; cin >> price;
-                cout << "Enter 5 taste numbers (sweet sour bitter salty savory): ";
+                cout << "Enter " << kTasteDims << " taste numbers (" << tasteDimNames() << "): ";
                 for (auto &v: t) cin >> v;
                 cin.ignore();
             }
 
-            shared_ptr<MenuItem> ititem;
-            if (cat=="Starter") ititem = make_shared<Starter>(name, price, t);
-            else if (cat=="Salad") ititem = make_shared<Salad>(name, price, t);
-            else if (cat=="MainCourse") {
+            if (catId == Category::Unknown) { cout << "Unknown category\n"; continue; }
+            bool isVeg = false;
+            if (catId == Category::MainCourse) {
                 // if catalog provided a matching item, try to read vegetarian flag; otherwise ask user
-                bool isVeg = false;
-                auto cit = catalog.find(cat);
-                if (cit != catalog.end()) {
-                    auto found = find_if(cit->second.begin(), cit->second.end(), [&](const json &j){ return j.value("name",string())==name; });
-                    if (found != cit->second.end() && found->contains("vegetarian") && (*found)["vegetarian"].is_boolean())
-                        isVeg = (*found)["vegetarian"].get<bool>();
-                    else {
-                        cout << "Vegetarian? (1=yes,0=no): ";
-                        int vv; if (!(cin>>vv)) { cin.clear(); cin.ignore(10000,'\n'); vv=0; }
-                        isVeg = (vv==1);
-                        cin.ignore();
+                bool known = false;
+                for (size_t i = range.first; i < range.second; ++i) {
+                    CatalogItem ci = catalog.item(i);
+                    if (ci.name != name) continue;
+                    if (ci.vegFlagged) {
+                        isVeg = ci.vegetarian;
+                        known = true;
                     }
-                } else {
+                    break;
+                }
+                if (!known) {
                     cout << "Vegetarian? (1=yes,0=no): ";
                     int vv; if (!(cin>>vv)) { cin.clear(); cin.ignore(10000,'\n'); vv=0; }
                     isVeg = (vv==1);
                     cin.ignore();
                 }
-                ititem = make_shared<MainCourse>(name, price, t, isVeg);
             }
-            else if (cat=="Drink") ititem = make_shared<Drink>(name, price, t);
-            else if (cat=="Appetizer") ititem = make_shared<Appetizer>(name, price, t);
-            else if (cat=="Dessert") ititem = make_shared<Dessert>(name, price, t);
-            else { cout << "Unknown category\n"; continue; }
+            shared_ptr<MenuItem> ititem = makeItem(catId, name, price, t, isVeg);
 
             if (ititem) {
                 ititem->customize();
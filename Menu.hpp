@@ -6,91 +6,141 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include "Category.hpp"
+#include "Taste.hpp"
 
 namespace menu {
 
 using json = nlohmann::json;
 
+class CatalogView; // Catalog.hpp
+
 // ========== BASE CLASS ==========
 class MenuItem {
 protected:
     std::string name;
     double price;
-    std::vector<double> taste; // [sweet, salty, sour, bitter, spicy]
+    Taste taste; // one value per kTasteNames entry
 
 public:
-    MenuItem(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5, 0.5));
+    MenuItem(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste());
     virtual ~MenuItem() = default;
 
-    virtual void printInfo() const = 0;
+    // printInfo writes the writeInfo line through the per-thread output buffer (Serializer.hpp)
+    void printInfo() const;
+    virtual void writeInfo(std::string &out) const = 0; // appends one text line
+    void writeJson(std::string &out) const;             // appends one JSON object
     virtual void customize() = 0;
+    virtual Category getCategory() const = 0;
+    // customization flags packed into a byte (bit layout is per class), used for compact storage
+    virtual std::uint8_t getOptions() const = 0;
+    virtual void setOptions(std::uint8_t o) = 0;
 
     std::string getName() const;
     double getPrice() const;
-    std::vector<double> getTaste() const;
+    const Taste &getTaste() const;
     double getTasteAvg() const;
 
     void setName(const std::string &n);
     void setPrice(double p);
-    void setTaste(const std::vector<double> &t);
+    void setTaste(const Taste &t);
+
+protected:
+    virtual void writeJsonOptions(std::string &out) const = 0; // ,"key":value pairs of the subclass
 };
 
 // ========== CHILD CLASSES ==========
 class Starter : public MenuItem {
     bool isHot;
 public:
-    Starter(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5,0.5), bool hot=false);
-    void printInfo() const override;
+    Starter(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste(), bool hot=false);
+    void writeInfo(std::string &out) const override;
     void customize() override;
+    Category getCategory() const override;
+    std::uint8_t getOptions() const override;
+    void setOptions(std::uint8_t o) override;
+protected:
+    void writeJsonOptions(std::string &out) const override;
 };
 
 class Salad : public MenuItem {
     bool hasTopping;
 public:
-    Salad(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5,0.5), bool topping=false);
-    void printInfo() const override;
+    Salad(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste(), bool topping=false);
+    void writeInfo(std::string &out) const override;
     void customize() override;
+    Category getCategory() const override;
+    std::uint8_t getOptions() const override;
+    void setOptions(std::uint8_t o) override;
+protected:
+    void writeJsonOptions(std::string &out) const override;
 };
 
 class MainCourse : public MenuItem {
     bool isVegetarian;
 public:
-    MainCourse(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5,0.5), bool veg=false);
-    void printInfo() const override;
+    MainCourse(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste(), bool veg=false);
+    void writeInfo(std::string &out) const override;
     void customize() override;
+    Category getCategory() const override;
+    std::uint8_t getOptions() const override;
+    void setOptions(std::uint8_t o) override;
+protected:
+    void writeJsonOptions(std::string &out) const override;
 };
 
 class Drink : public MenuItem {
     bool carbonated;
     bool extraShot;
 public:
-    Drink(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5,0.5), bool carb=false, bool shot=false);
-    void printInfo() const override;
+    Drink(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste(), bool carb=false, bool shot=false);
+    void writeInfo(std::string &out) const override;
     void customize() override;
+    Category getCategory() const override;
+    std::uint8_t getOptions() const override;
+    void setOptions(std::uint8_t o) override;
+protected:
+    void writeJsonOptions(std::string &out) const override;
 };
 
 class Appetizer : public MenuItem {
     std::string serveTime;
 public:
-    Appetizer(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5,0.5), const std::string &serve="before");
-    void printInfo() const override;
+    Appetizer(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste(), const std::string &serve="before");
+    void writeInfo(std::string &out) const override;
     void customize() override;
+    Category getCategory() const override;
+    std::uint8_t getOptions() const override;
+    void setOptions(std::uint8_t o) override;
+protected:
+    void writeJsonOptions(std::string &out) const override;
 };
 
 class Dessert : public MenuItem {
     bool extraChocolate;
 public:
-    Dessert(const std::string &n = "", double p = 0.0, const std::vector<double> &t = std::vector<double>(5,0.5), bool choc=false);
-    void printInfo() const override;
+    Dessert(const std::string &n = "", double p = 0.0, const Taste &t = neutralTaste(), bool choc=false);
+    void writeInfo(std::string &out) const override;
     void customize() override;
+    Category getCategory() const override;
+    std::uint8_t getOptions() const override;
+    void setOptions(std::uint8_t o) override;
+protected:
+    void writeJsonOptions(std::string &out) const override;
 };
 
+// ========== FACTORY ==========
+// builds the concrete item for a category via the registry's dispatch table;
+// the vegetarian flag is only used by MainCourse, Unknown falls back to Starter
+std::shared_ptr<MenuItem> makeItem(Category c, const std::string &n, double p, const Taste &t, bool veg = false);
+
 // ========== MENU & USER ==========
 class Menu {
     std::vector<std::shared_ptr<MenuItem>> items;
     double totalCost;
-    std::vector<double> tasteAvg; // average taste vector
+    Taste tasteAvg; // average taste vector
 public:
     Menu();
     void addItem(std::shared_ptr<MenuItem> item);
@@ -98,7 +148,8 @@ public:
     void updateItem(const std::string &name);
     void showMenu() const;
     double getTotalCost() const;
-    std::vector<double> getTasteAvg() const;
+    const Taste &getTasteAvg() const;
+    const std::vector<std::shared_ptr<MenuItem>> &getItems() const;
 };
 
 class User {
@@ -110,9 +161,13 @@ public:
     User(const std::string &f="", const std::string &l="", const std::string &g="");
     void showInfo() const;
     Menu &getMenu();
+    const Menu &getMenu() const;
+    const std::string &getFirstName() const;
+    const std::string &getLastName() const;
+    const std::string &getGender() const;
 
     // updated: accept catalog so interact can list existing items per category
-    void interact(const std::map<std::string, std::vector<json>> &catalog);
+    void interact(const CatalogView &catalog);
 };
 
 } // namespace menu
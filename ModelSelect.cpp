@@ -0,0 +1,319 @@
+#include "ModelSelect.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "AI.hpp"
+#include "Serializer.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+using menu::kTasteDims;
+
+namespace ai {
+
+void writeFeedback(string &out, const menu::Taste &taste, double rating) {
+    out += "{\"taste\":[";
+    for (size_t i = 0; i < taste.size(); ++i) {
+        if (i) out += ',';
+        menu::appendJsonNumber(out, taste[i]);
+    }
+    out += "],\"rating\":";
+    menu::appendJsonNumber(out, rating);
+    out += "}\n";
+}
+
+bool appendFeedback(const string &filename, const menu::Taste &taste, double rating) {
+    ofstream file(filename, ios::app);
+    if (!file.is_open()) {
+        cerr << "Warning: could not open " << filename << " to record feedback\n";
+        return false;
+    }
+    string &out = menu::outputBuffer();
+    writeFeedback(out, taste, rating);
+    menu::flushOutput(out, file);
+    return true;
+}
+
+vector<Feedback> loadFeedback(const string &filename) {
+    vector<Feedback> data;
+    ifstream file(filename);
+    if (!file.is_open()) return data;
+    string line;
+    size_t lineNo = 0, bad = 0;
+    while (getline(file, line)) {
+        ++lineNo;
+        if (line.empty()) continue;
+        json j = json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.contains("taste") || !j["taste"].is_array() || !j.contains("rating") || !j["rating"].is_number()) {
+            if (bad++ == 0) cerr << "Warning: skipping malformed feedback at " << filename << ":" << lineNo << "\n";
+            continue;
+        }
+        Feedback f{menu::neutralTaste(), j["rating"].get<double>()};
+        size_t idx = 0;
+        for (auto &v : j["taste"]) if (idx < kTasteDims && v.is_number()) f.taste[idx++] = v.get<double>();
+        data.push_back(f);
+    }
+    if (bad > 1) cerr << "Warning: skipped " << bad << " malformed feedback lines in " << filename << "\n";
+    return data;
+}
+
+vector<ModelConfig> defaultModelGrid() {
+    vector<ModelConfig> grid;
+    for (bool inter : {false, true})
+        for (int epochs : {1, 5, 20, 50})
+            for (double alpha : {0.001, 0.003, 0.01, 0.03, 0.1, 0.3})
+                for (double l2 : {0.0, 1e-4, 1e-3, 1e-2, 1e-1})
+                    grid.push_back({alpha, l2, epochs, inter});
+    return grid;
+}
+
+namespace {
+
+constexpr size_t kInteractionDims = kTasteDims + kTasteDims * (kTasteDims - 1) / 2;
+
+// row-major feature rows (no bias column), shared read-only by the workers
+struct FeatureMatrix {
+    size_t cols = 0;
+    vector<double> x;
+    const double *row(size_t r) const { return &x[r * cols]; }
+};
+
+FeatureMatrix expandFeatures(const vector<Feedback> &data, bool interactions) {
+    FeatureMatrix m;
+    m.cols = interactions ? kInteractionDims : kTasteDims;
+    m.x.reserve(data.size() * m.cols);
+    for (auto &f : data) {
+        m.x.insert(m.x.end(), f.taste.begin(), f.taste.end());
+        if (!interactions) continue;
+        for (size_t i = 0; i < kTasteDims; ++i)
+            for (size_t j = i + 1; j < kTasteDims; ++j) m.x.push_back(f.taste[i] * f.taste[j]);
+    }
+    return m;
+}
+
+vector<string> featureNames(bool interactions) {
+    vector<string> names;
+    for (size_t i = 0; i < kTasteDims; ++i) names.emplace_back(menu::kTasteNames[i]);
+    if (interactions)
+        for (size_t i = 0; i < kTasteDims; ++i)
+            for (size_t j = i + 1; j < kTasteDims; ++j) names.push_back(string(menu::kTasteNames[i]) + "*" + string(menu::kTasteNames[j]));
+    return names;
+}
+
+// C is the feature count, known at compile time for both feature sets so the row loops unroll
+template <size_t C>
+double predictRow(const vector<double> &w, const double *x) {
+    double y = w[0];
+    for (size_t i = 0; i < C; ++i) y += w[i + 1] * x[i];
+    return y;
+}
+
+// the BasicLinearRegression update (same 0.1 start), over feature rows;
+// onEpoch(e, w) runs after each pass, e counting from 1
+template <size_t C, class OnEpoch>
+vector<double> fitRows(const FeatureMatrix &m, const vector<double> &y, vector<uint32_t> rows, const ModelConfig &c, uint64_t seed, OnEpoch onEpoch) {
+    vector<double> w(C + 1, 0.1);
+    mt19937_64 rng(seed);
+    for (int e = 1; e <= c.epochs; ++e) {
+        shuffle(rows.begin(), rows.end(), rng);
+        for (uint32_t r : rows) {
+            const double *x = m.row(r);
+            double err = y[r] - predictRow<C>(w, x);
+            for (size_t i = 0; i < C; ++i) w[i + 1] += c.alpha * err * x[i] - c.alpha * c.l2 * w[i + 1];
+            w[0] += c.alpha * err;
+        }
+        onEpoch(e, w);
+    }
+    return w;
+}
+
+template <class OnEpoch>
+vector<double> fit(const FeatureMatrix &m, const vector<double> &y, const vector<uint32_t> &rows, const ModelConfig &c, uint64_t seed, OnEpoch onEpoch) {
+    return m.cols == kTasteDims ? fitRows<kTasteDims>(m, y, rows, c, seed, onEpoch) : fitRows<kInteractionDims>(m, y, rows, c, seed, onEpoch);
+}
+
+double heldOutSse(const FeatureMatrix &m, const vector<double> &y, const vector<uint32_t> &rows, const vector<double> &w) {
+    double s = 0;
+    for (uint32_t r : rows) {
+        double d = (m.cols == kTasteDims ? predictRow<kTasteDims>(w, m.row(r)) : predictRow<kInteractionDims>(w, m.row(r))) - y[r];
+        s += d*d;
+    }
+    return s;
+}
+
+int workerCount(const ModelSelectConfig &cfg) {
+    return cfg.threads > 0 ? cfg.threads : max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+} // namespace
+
+ModelSelection selectModel(const vector<Feedback> &data, const vector<ModelConfig> &grid, const ModelSelectConfig &cfg) {
+    ModelSelection sel;
+    if (data.size() < 2 || grid.empty()) return sel;
+
+    // everything the workers read is built up front
+    vector<double> y(data.size());
+    for (size_t i = 0; i < data.size(); ++i) y[i] = data[i].rating;
+    const FeatureMatrix plain = expandFeatures(data, false);
+    const FeatureMatrix inter = expandFeatures(data, true);
+
+    size_t folds = static_cast<size_t>(max(2, cfg.folds));
+    folds = min(folds, data.size());
+    vector<uint32_t> perm(data.size());
+    iota(perm.begin(), perm.end(), 0u);
+    shuffle(perm.begin(), perm.end(), mt19937_64(cfg.seed));
+    vector<vector<uint32_t>> trainRows(folds), testRows(folds);
+    for (size_t f = 0; f < folds; ++f) {
+        size_t lo = f * perm.size() / folds, hi = (f + 1) * perm.size() / folds;
+        for (size_t i = 0; i < perm.size(); ++i) (i >= lo && i < hi ? testRows[f] : trainRows[f]).push_back(perm[i]);
+    }
+
+    // configs that differ only in epochs share one training run (same seed, so the
+    // shorter runs are prefixes of the longest) and are scored at their epoch counts
+    struct Run {
+        ModelConfig config;                   // with the largest epoch count
+        vector<pair<int, size_t>> checkpoints; // (epochs, grid index)
+    };
+    vector<Run> runs;
+    for (size_t g = 0; g < grid.size(); ++g) {
+        const ModelConfig &c = grid[g];
+        auto it = find_if(runs.begin(), runs.end(), [&](const Run &r) {
+            return r.config.alpha == c.alpha && r.config.l2 == c.l2 && r.config.interactions == c.interactions;
+        });
+        if (it == runs.end()) it = runs.insert(runs.end(), Run{c, {}});
+        it->config.epochs = max(it->config.epochs, c.epochs);
+        it->checkpoints.push_back({c.epochs, g});
+    }
+
+    // one job per (run, fold); each writes only its own configs' slots
+    const size_t jobs = runs.size() * folds;
+    vector<double> sse(grid.size() * folds, 0.0);
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t job; (job = next++) < jobs;) {
+            const Run &run = runs[job / folds];
+            size_t f = job % folds;
+            const FeatureMatrix &m = run.config.interactions ? inter : plain;
+            fit(m, y, trainRows[f], run.config, cfg.seed + job, [&](int e, const vector<double> &w) {
+                for (auto &cp : run.checkpoints)
+                    if (cp.first == e) sse[cp.second * folds + f] = heldOutSse(m, y, testRows[f], w);
+            });
+        }
+    };
+    vector<thread> pool;
+    for (int i = 0; i < workerCount(cfg); ++i) pool.emplace_back(worker);
+    for (auto &t : pool) t.join();
+
+    for (size_t g = 0; g < grid.size(); ++g) {
+        double s = 0;
+        for (size_t f = 0; f < folds; ++f) s += sse[g * folds + f];
+        double rmse = sqrt(s / data.size());
+        sel.scores.push_back({grid[g], isfinite(rmse) ? rmse : numeric_limits<double>::infinity()});
+    }
+    // ties go to the cheaper model: no interactions, then fewer epochs
+    stable_sort(sel.scores.begin(), sel.scores.end(), [](const ModelScore &a, const ModelScore &b) {
+        if (a.rmse != b.rmse) return a.rmse < b.rmse;
+        if (a.config.interactions != b.config.interactions) return !a.config.interactions;
+        return a.config.epochs < b.config.epochs;
+    });
+
+    vector<uint32_t> all(data.size());
+    iota(all.begin(), all.end(), 0u);
+    auto refit = [&](const ModelConfig &c) {
+        return fit(c.interactions ? inter : plain, y, all, c, cfg.seed, [](int, const vector<double> &) {});
+    };
+    const ModelConfig &best = sel.scores.front().config;
+    sel.weights = refit(best);
+    sel.features = featureNames(best.interactions);
+
+    // the bot can only run a linear model, so the best of those is kept as well
+    auto linear = find_if(sel.scores.begin(), sel.scores.end(), [](const ModelScore &s) { return !s.config.interactions; });
+    if (linear != sel.scores.end()) {
+        sel.bestLinear = static_cast<size_t>(linear - sel.scores.begin());
+        sel.linearWeights = sel.bestLinear == 0 ? sel.weights : refit(linear->config);
+    }
+    return sel;
+}
+
+bool parseModelSelectArg(const string &arg, ModelSelectConfig &cfg) {
+    if (arg.rfind("--feedback=", 0) == 0) cfg.feedbackFile = arg.substr(11);
+    else if (arg.rfind("--folds=", 0) == 0) cfg.folds = max(2, atoi(arg.c_str() + 8));
+    else if (arg.rfind("--search-threads=", 0) == 0) cfg.threads = max(0, atoi(arg.c_str() + 17));
+    else return false;
+    return true;
+}
+
+int runModelSelection(const ModelSelectConfig &cfg) {
+    auto data = loadFeedback(cfg.feedbackFile);
+    if (data.size() < 2) {
+        cerr << "Model selection: need at least 2 ratings in " << cfg.feedbackFile << " (found " << data.size() << ")\n";
+        return 1;
+    }
+    auto grid = defaultModelGrid();
+    auto t0 = chrono::steady_clock::now();
+    auto sel = selectModel(data, grid, cfg);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    int folds = static_cast<int>(min<size_t>(static_cast<size_t>(max(2, cfg.folds)), data.size()));
+
+    cout << "Model selection: " << grid.size() << " configurations x " << folds << " folds over "
+         << data.size() << " ratings, threads: " << workerCount(cfg) << ", " << fixed << setprecision(2) << secs << " s\n";
+    cout << setw(6) << "rank" << setw(9) << "alpha" << setw(9) << "l2" << setw(8) << "epochs"
+         << setw(14) << "features" << setw(11) << "cv rmse" << "\n";
+    auto row = [&](size_t rank, const ModelScore &s, const char *note) {
+        cout << setw(6) << rank << setw(9) << setprecision(4) << s.config.alpha << setw(9) << s.config.l2
+             << setw(8) << s.config.epochs << setw(14) << (s.config.interactions ? "interactions" : "linear")
+             << setw(11) << setprecision(5) << s.rmse << note << "\n";
+    };
+    for (size_t i = 0; i < sel.scores.size(); ++i) {
+        const auto &c = sel.scores[i].config;
+        // the bot's settings before any selection: alpha 0.01, no decay, one pass
+        bool current = c.alpha == 0.01 && c.l2 == 0 && c.epochs == 1 && !c.interactions;
+        if (i < 10 || current) row(i + 1, sel.scores[i], current ? "  (current default)" : "");
+    }
+
+    auto configJson = [](const ModelConfig &c) {
+        return json{{"alpha", c.alpha}, {"l2", c.l2}, {"epochs", c.epochs}, {"interactions", c.interactions}};
+    };
+    const ModelScore &win = sel.scores.front();
+    json out;
+    out["config"] = configJson(win.config);
+    out["cv_rmse"] = win.rmse;
+    out["folds"] = folds;
+    out["ratings"] = data.size();
+    out["features"] = sel.features;
+    out["weights"] = sel.weights;
+    if (sel.bestLinear != ModelSelection::npos) {
+        const ModelScore &lin = sel.scores[sel.bestLinear];
+        out["best_linear"] = {{"config", configJson(lin.config)}, {"cv_rmse", lin.rmse}, {"rank", sel.bestLinear + 1},
+                              {"features", featureNames(false)}, {"weights", sel.linearWeights}};
+    }
+    ofstream file(cfg.outputFile);
+    if (!file.is_open()) cerr << "Warning: could not open " << cfg.outputFile << " to save the selected model\n";
+    else { file << out.dump(4); cout << "Winner written to " << cfg.outputFile << "\n"; }
+
+    if (sel.bestLinear != ModelSelection::npos) {
+        // the bot's own model: trained weights plus the learning rate and decay to keep training with
+        const ModelScore &lin = sel.scores[sel.bestLinear];
+        if (sel.bestLinear != 0)
+            cout << "The winner needs interaction features, which the bot's linear model does not have; using the best linear model"
+                 << " (rank " << sel.bestLinear + 1 << ", cv rmse " << lin.rmse << ", +" << lin.rmse - win.rmse << ")\n";
+        LinearRegression model(lin.config.alpha, lin.config.l2);
+        array<double, kTasteDims + 1> w;
+        copy(sel.linearWeights.begin(), sel.linearWeights.end(), w.begin());
+        model.setWeights(w);
+        model.saveWeights(cfg.weightsFile);
+        cout << "Weights, learning rate and L2 written to " << cfg.weightsFile << "\n";
+    }
+    return 0;
+}
+
+} // namespace ai
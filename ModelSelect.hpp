@@ -0,0 +1,74 @@
+#ifndef MODEL_SELECT_HPP
+#define MODEL_SELECT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Taste.hpp"
+
+namespace ai {
+
+// ========== FEEDBACK ==========
+// Every rating the bot trains on is appended to a JSON-lines file
+// ({"taste":[...],"rating":r}) so model settings can be chosen offline.
+struct Feedback {
+    menu::Taste taste;
+    double rating;
+};
+
+// one line of the feedback file
+void writeFeedback(std::string &out, const menu::Taste &taste, double rating);
+bool appendFeedback(const std::string &filename, const menu::Taste &taste, double rating);
+// bad lines are skipped with a warning; missing dimensions default to 0.5
+std::vector<Feedback> loadFeedback(const std::string &filename);
+
+// ========== MODEL SELECTION ==========
+// Grid search over SGD settings with k-fold cross-validation. The dataset is
+// expanded into one flat feature matrix per feature set before any training,
+// and worker threads only read it; each (config, fold) pair is one job.
+struct ModelConfig {
+    double alpha = 0.01;       // learning rate
+    double l2 = 0;             // weight decay (bias excluded)
+    int epochs = 1;            // passes over the training folds, shuffled each pass
+    bool interactions = false; // adds every pairwise product taste[i]*taste[j]
+};
+
+struct ModelSelectConfig {
+    std::string feedbackFile = "feedback.jsonl";
+    std::string outputFile = "model_selection.json";
+    std::string weightsFile = "weights.json"; // always gets the best plain linear model
+    int folds = 5;
+    int threads = 0; // 0 = hardware concurrency
+    std::uint64_t seed = 1;
+};
+
+struct ModelScore {
+    ModelConfig config;
+    double rmse; // cross-validated; +inf if training diverged
+};
+
+struct ModelSelection {
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::vector<ModelScore> scores;    // best first
+    std::vector<double> weights;       // winner retrained on all the data: [bias, features...]
+    std::vector<std::string> features; // names of the winner's features
+    std::size_t bestLinear = npos;     // index in scores of the best model without interactions
+    std::vector<double> linearWeights; // that model retrained on all the data
+};
+
+// learning rate x L2 x epochs x {plain, interactions}: 240 configurations
+std::vector<ModelConfig> defaultModelGrid();
+
+ModelSelection selectModel(const std::vector<Feedback> &data, const std::vector<ModelConfig> &grid, const ModelSelectConfig &cfg);
+
+// consumes one model selection flag (--feedback=, --folds=, --search-threads=); false if arg is not one
+bool parseModelSelectArg(const std::string &arg, ModelSelectConfig &cfg);
+
+// loads the feedback, searches the default grid, prints the ranking and writes the winner
+// (plus the best linear model, which goes to weights.json); returns an exit code
+int runModelSelection(const ModelSelectConfig &cfg);
+
+} // namespace ai
+
+#endif
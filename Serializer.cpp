@@ -0,0 +1,98 @@
+#include "Serializer.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include "AllocTracker.hpp"
+
+using namespace std;
+
+namespace menu {
+
+string &outputBuffer() {
+    thread_local string buf;
+    buf.clear();
+    return buf;
+}
+
+void appendNumber(string &out, double v, const ios_base &fmt) {
+    char tmp[64];
+    auto field = fmt.flags() & ios_base::floatfield;
+    int prec = static_cast<int>(fmt.precision());
+    to_chars_result r;
+    if (field == ios_base::fixed) r = to_chars(tmp, tmp + sizeof(tmp), v, chars_format::fixed, prec);
+    else if (field == ios_base::scientific) r = to_chars(tmp, tmp + sizeof(tmp), v, chars_format::scientific, prec);
+    else r = to_chars(tmp, tmp + sizeof(tmp), v, chars_format::general, prec == 0 ? 1 : prec); // %g treats 0 as 1
+    if (r.ec != errc()) {
+        // huge fixed values do not fit the scratch buffer; rare enough for snprintf
+        int n = snprintf(tmp, sizeof(tmp), "%g", v);
+        out.append(tmp, static_cast<size_t>(max(0, min(n, static_cast<int>(sizeof(tmp)) - 1))));
+        return;
+    }
+    out.append(tmp, r.ptr);
+}
+
+void appendNumber(string &out, size_t v) {
+    char tmp[24];
+    auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+    out.append(tmp, r.ptr);
+}
+
+void appendJsonNumber(string &out, double v) {
+    if (!isfinite(v)) { out += "null"; return; }
+    char tmp[32];
+    auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+    out.append(tmp, r.ptr);
+}
+
+void appendJsonString(string &out, string_view s) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    out += '"';
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += kHex[(c >> 4) & 0xf];
+                    out += kHex[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void writeMenu(string &out, const vector<shared_ptr<MenuItem>> &menu, OutputFormat f) {
+    AllocPhaseScope phase(AllocPhase::Output);
+    double total = 0;
+    if (f == OutputFormat::Text) {
+        for (auto &it : menu) { it->writeInfo(out); total += it->getPrice(); }
+        out += "Total Cost: $";
+        char tmp[64];
+        auto r = to_chars(tmp, tmp + sizeof(tmp), total, chars_format::fixed, 2);
+        out.append(tmp, r.ptr);
+        out += '\n';
+        return;
+    }
+    out += "{\"items\":[";
+    for (size_t i = 0; i < menu.size(); ++i) {
+        if (i) out += ',';
+        menu[i]->writeJson(out);
+        total += menu[i]->getPrice();
+    }
+    out += "],\"total\":";
+    appendJsonNumber(out, total);
+    out += "}\n";
+}
+
+void flushOutput(string &out, ostream &os) {
+    os.write(out.data(), static_cast<streamsize>(out.size()));
+    out.clear();
+}
+
+} // namespace menu
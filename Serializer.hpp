@@ -0,0 +1,38 @@
+#ifndef SERIALIZER_HPP
+#define SERIALIZER_HPP
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Menu.hpp"
+
+namespace menu {
+
+// ========== SERIALIZER ==========
+// Output for items and menus is formatted into a reusable per-thread buffer
+// with std::to_chars and leaves in one write, instead of field-by-field
+// iostream formatting. Text output is byte-identical to the old operator<<
+// layout: numbers follow the stream's current fixed/precision state.
+enum class OutputFormat { Text, JsonLines };
+
+// per-thread buffer, handed out empty; its capacity is kept between uses
+std::string &outputBuffer();
+
+// as `os << v` would print it (general or fixed, os.precision() digits)
+void appendNumber(std::string &out, double v, const std::ios_base &fmt = std::cout);
+void appendNumber(std::string &out, std::size_t v);
+// shortest round-trip form, for JSON
+void appendJsonNumber(std::string &out, double v);
+void appendJsonString(std::string &out, std::string_view s);
+
+// one item per line plus the total (Text), or one JSON object per menu (JsonLines)
+void writeMenu(std::string &out, const std::vector<std::shared_ptr<MenuItem>> &menu, OutputFormat f);
+
+// single write of the buffer, which is then cleared
+void flushOutput(std::string &out, std::ostream &os = std::cout);
+
+} // namespace menu
+
+#endif
@@ -0,0 +1,416 @@
+#include "Session.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <iostream>
+
+using namespace std;
+
+namespace menu {
+
+// ========== BINARY HELPERS ==========
+template <class T>
+static void put(string &out, const T &v) { out.append(reinterpret_cast<const char *>(&v), sizeof(T)); }
+static void putStr(string &out, const string &s) { put(out, static_cast<uint32_t>(s.size())); out += s; }
+
+// bounds-checked reader over an encoded record
+struct Reader {
+    const string &in;
+    size_t pos = 0;
+    bool ok = true;
+    template <class T>
+    T get() {
+        T v{};
+        if (pos + sizeof(T) > in.size()) { ok = false; return v; }
+        memcpy(&v, in.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    string getStr() {
+        uint32_t n = get<uint32_t>();
+        if (!ok || pos + n > in.size()) { ok = false; return string(); }
+        string s = in.substr(pos, n);
+        pos += n;
+        return s;
+    }
+};
+
+static string refKey(Category c, const string &name) { return string(categoryName(c)) + '\n' + name; }
+
+// first bytes of a spill file: a format tag and the taste dimensions the records hold; a file
+// with any other header (an older layout, a build with another MENU_TASTE_DIMS) is discarded
+struct SpillHeader {
+    char magic[8];
+    uint32_t tasteDims;
+};
+static constexpr SpillHeader kSpillHeader{{'M', 'E', 'N', 'U', 'S', 'E', 'S', '4'}, static_cast<uint32_t>(kTasteDims)};
+static const char *spillHeaderBytes() { return reinterpret_cast<const char *>(&kSpillHeader); }
+static constexpr uint32_t kRecordHeader = sizeof(uint64_t) + sizeof(uint32_t);
+static constexpr uint64_t kSpillFailed = numeric_limits<uint64_t>::max();
+
+// ========== STORE ==========
+SessionStore::SessionStore(const CatalogView &catalog, const string &spillFile, size_t shardCount)
+    : catalog(catalog), spillPath(spillFile) {
+    for (size_t i = 0; i < catalog.itemCount(); ++i) {
+        CatalogItem ci = catalog.item(i);
+        refByKey.emplace(refKey(ci.category, ci.name), static_cast<uint32_t>(i));
+    }
+    for (size_t i = 0; i < max<size_t>(1, shardCount); ++i) shards.push_back(make_unique<Shard>());
+
+    spill.open(spillPath, ios::in | ios::out | ios::binary);
+    if (!spill.is_open()) {
+        ofstream create(spillPath, ios::binary); // first run: create the file
+        create.close();
+        spill.open(spillPath, ios::in | ios::out | ios::binary);
+    }
+    if (!spill.is_open()) cerr << "Warning: could not open " << spillPath << ", idle sessions will stay in memory\n";
+    else {
+        reindex();
+        // no other thread can see the store yet, so the locks compact() expects are not needed
+        if (fileBytes > sizeof(SpillHeader) + liveBytes) compact();
+    }
+}
+
+void SessionStore::save(SessionId id, const User &user) {
+    CompactSession s = pack(user);
+    Shard &sh = shardFor(id);
+    lock_guard<mutex> lock(sh.mutex);
+    dropSpilled(sh, id); // the resident copy is newer
+    sh.resident[id] = std::move(s);
+}
+
+bool SessionStore::load(SessionId id, User &user) {
+    Shard &sh = shardFor(id);
+    lock_guard<mutex> lock(sh.mutex);
+    if (!restore(sh, id)) return false;
+    auto &s = sh.resident[id];
+    s.lastUsed = chrono::steady_clock::now();
+    unpack(s, user);
+    return true;
+}
+
+bool SessionStore::erase(SessionId id) {
+    {
+        Shard &sh = shardFor(id);
+        lock_guard<mutex> lock(sh.mutex);
+        bool found = sh.resident.erase(id) > 0;
+        if (sh.spilled.count(id)) { dropSpilled(sh, id); found = true; }
+        if (!found) return false;
+        appendRecord(id, string()); // tombstone, so a reopened store forgets it too
+    }
+    maybeCompact();
+    return true;
+}
+
+bool SessionStore::summary(SessionId id, double &totalCost, Taste &tasteAvg) {
+    Shard &sh = shardFor(id);
+    lock_guard<mutex> lock(sh.mutex);
+    if (!restore(sh, id)) return false;
+    const auto &s = sh.resident[id];
+    totalCost = s.totalCost;
+    if (s.items.empty()) tasteAvg = neutralTaste();
+    else for (size_t i = 0; i < kTasteDims; ++i) tasteAvg[i] = s.tasteSum[i] / s.items.size();
+    return true;
+}
+
+size_t SessionStore::evictIdle(chrono::steady_clock::duration idle) {
+    if (!spill.is_open()) return 0;
+    auto now = chrono::steady_clock::now();
+    size_t evicted = 0;
+    for (auto &shp : shards) {
+        Shard &sh = *shp;
+        lock_guard<mutex> lock(sh.mutex);
+        for (auto it = sh.resident.begin(); it != sh.resident.end();) {
+            if (now - it->second.lastUsed < idle) { ++it; continue; }
+            SpillRef ref = appendRecord(it->first, encode(it->second));
+            if (ref.offset == kSpillFailed) { ++it; continue; } // write failed, keep it resident
+            sh.spilled[it->first] = ref;
+            liveBytes += ref.bytes;
+            it = sh.resident.erase(it);
+            ++evicted;
+        }
+    }
+    maybeCompact();
+    return evicted;
+}
+
+size_t SessionStore::residentCount() const {
+    size_t n = 0;
+    for (auto &sh : shards) { lock_guard<mutex> lock(sh->mutex); n += sh->resident.size(); }
+    return n;
+}
+
+size_t SessionStore::spilledCount() const {
+    size_t n = 0;
+    for (auto &sh : shards) { lock_guard<mutex> lock(sh->mutex); n += sh->spilled.size(); }
+    return n;
+}
+
+size_t SessionStore::memoryBytes() const {
+    size_t b = 0;
+    for (auto &sh : shards) {
+        lock_guard<mutex> lock(sh->mutex);
+        b += sh->resident.bucket_count() * sizeof(void *);
+        for (auto &kv : sh->resident) {
+            const auto &s = kv.second;
+            b += sizeof(kv) + 2 * sizeof(void *); // node + hash/link overhead
+            b += s.items.capacity() * sizeof(SessionItem) + s.manual.capacity() * sizeof(ManualItem);
+            if (s.firstName.capacity() > 15) b += s.firstName.capacity();
+            if (s.lastName.capacity() > 15) b += s.lastName.capacity();
+        }
+    }
+    return b;
+}
+
+// ========== PACK / UNPACK ==========
+SessionStore::CompactSession SessionStore::pack(const User &user) const {
+    CompactSession s;
+    s.firstName = user.getFirstName();
+    s.lastName = user.getLastName();
+    s.gender = user.getGender();
+    s.lastUsed = chrono::steady_clock::now();
+    const auto &items = user.getMenu().getItems();
+    s.items.reserve(items.size());
+    for (const auto &it : items) {
+        Category c = it->getCategory();
+        const Taste &t = it->getTaste();
+        uint32_t ref = kManualItem;
+        auto f = refByKey.find(refKey(c, it->getName()));
+        // a hand-typed item may reuse a catalog name with other tastes; only an exact match becomes a ref
+        if (f != refByKey.end() && catalog.item(f->second).taste == t) ref = f->second;
+        if (ref == kManualItem) {
+            ManualItem m{it->getName(), c, t};
+            s.manual.push_back(std::move(m));
+        }
+        s.items.push_back({ref, it->getOptions(), it->getPrice()});
+        s.totalCost += it->getPrice();
+        for (size_t i = 0; i < kTasteDims; ++i) s.tasteSum[i] += static_cast<float>(t[i]);
+    }
+    return s;
+}
+
+void SessionStore::unpack(const CompactSession &s, User &user) const {
+    user = User(s.firstName, s.lastName, s.gender);
+    size_t manualIdx = 0;
+    for (const auto &si : s.items) {
+        shared_ptr<MenuItem> item;
+        if (si.ref != kManualItem) {
+            item = catalog.makeItem(si.ref);
+        } else {
+            const ManualItem &m = s.manual[manualIdx++];
+            item = makeItem(m.category, m.name, si.price, m.taste);
+        }
+        item->setOptions(si.options);
+        item->setPrice(si.price);
+        user.getMenu().addItem(item);
+    }
+}
+
+// ========== SPILL FILE ==========
+// file: magic, then records [u64 id][u32 length][length bytes]; length 0 is a tombstone
+
+bool SessionStore::restore(Shard &sh, SessionId id) {
+    if (sh.resident.count(id)) return true;
+    auto sp = sh.spilled.find(id);
+    if (sp == sh.spilled.end()) return false;
+
+    string bytes;
+    {
+        lock_guard<mutex> lock(spillMutex);
+        spill.clear();
+        spill.seekg(static_cast<streamoff>(sp->second.offset));
+        uint64_t rid = 0; uint32_t len = 0;
+        spill.read(reinterpret_cast<char *>(&rid), sizeof(rid));
+        spill.read(reinterpret_cast<char *>(&len), sizeof(len));
+        bytes.resize(len);
+        if (spill && len) spill.read(&bytes[0], len);
+        if (!spill || rid != id) { cerr << "Warning: spilled session " << id << " is unreadable\n"; return false; }
+    }
+    CompactSession s;
+    size_t stale = 0;
+    if (!decode(bytes, s, stale)) { cerr << "Warning: spilled session " << id << " is corrupt\n"; return false; }
+    if (stale)
+        cerr << "Warning: " << stale << " item(s) of session " << id
+             << " are no longer in the catalog as saved; restored from the session file\n";
+    s.lastUsed = chrono::steady_clock::now();
+    sh.resident[id] = std::move(s);
+    dropSpilled(sh, id);
+    return true;
+}
+
+// caller holds the shard lock; the record stays in the file as dead bytes until compact()
+void SessionStore::dropSpilled(Shard &sh, SessionId id) {
+    auto sp = sh.spilled.find(id);
+    if (sp == sh.spilled.end()) return;
+    liveBytes -= sp->second.bytes;
+    sh.spilled.erase(sp);
+}
+
+SessionStore::SpillRef SessionStore::appendRecord(SessionId id, const string &bytes) {
+    lock_guard<mutex> lock(spillMutex);
+    if (!spill.is_open()) return {kSpillFailed, 0};
+    spill.clear();
+    spill.seekp(0, ios::end);
+    auto off = static_cast<uint64_t>(spill.tellp());
+    uint32_t len = static_cast<uint32_t>(bytes.size());
+    spill.write(reinterpret_cast<const char *>(&id), sizeof(id));
+    spill.write(reinterpret_cast<const char *>(&len), sizeof(len));
+    spill.write(bytes.data(), len);
+    spill.flush();
+    if (!spill) { cerr << "Warning: could not write to " << spillPath << "\n"; return {kSpillFailed, 0}; }
+    fileBytes = off + kRecordHeader + len;
+    return {off, kRecordHeader + len};
+}
+
+// rebuild the id -> latest record map from an existing spill file
+void SessionStore::reindex() {
+    lock_guard<mutex> lock(spillMutex);
+    spill.clear();
+    spill.seekg(0, ios::end);
+    fileBytes = static_cast<uint64_t>(spill.tellg());
+    spill.seekg(0, ios::beg);
+    if (fileBytes == 0) {
+        spill.write(spillHeaderBytes(), sizeof(SpillHeader));
+        spill.flush();
+        fileBytes = sizeof(SpillHeader);
+        return;
+    }
+    char header[sizeof(SpillHeader)] = {};
+    if (!spill.read(header, sizeof(header)) || memcmp(header, spillHeaderBytes(), sizeof(header)) != 0) {
+        cerr << "Warning: " << spillPath << " is not a session file of this version or taste size, its sessions are discarded\n";
+        spill.close();
+        spill.open(spillPath, ios::in | ios::out | ios::binary | ios::trunc);
+        spill.write(spillHeaderBytes(), sizeof(SpillHeader));
+        spill.flush();
+        fileBytes = sizeof(SpillHeader);
+        return;
+    }
+    uint64_t off = sizeof(SpillHeader);
+    while (true) {
+        uint64_t id = 0; uint32_t len = 0;
+        if (!spill.read(reinterpret_cast<char *>(&id), sizeof(id))) break;
+        if (!spill.read(reinterpret_cast<char *>(&len), sizeof(len))) break;
+        if (off + kRecordHeader + len > fileBytes) break; // torn last write
+        Shard &sh = shardFor(id);
+        dropSpilled(sh, id);
+        if (len) { sh.spilled[id] = {off, kRecordHeader + len}; liveBytes += kRecordHeader + len; }
+        spill.seekg(len, ios::cur);
+        off += kRecordHeader + len;
+    }
+    spill.clear();
+}
+
+void SessionStore::maybeCompact() {
+    // superseded records and tombstones may take as much room as the live ones before a rewrite
+    auto worthIt = [&] { return fileBytes > sizeof(SpillHeader) + 2 * liveBytes; };
+    if (!spill.is_open() || !worthIt()) return;
+    vector<unique_lock<mutex>> locks; // always shard order, then the file, like every other path
+    for (auto &sh : shards) locks.emplace_back(sh->mutex);
+    lock_guard<mutex> lock(spillMutex);
+    if (spill.is_open() && worthIt()) compact();
+}
+
+void SessionStore::compact() {
+    namespace fs = std::filesystem;
+    string tmpPath = spillPath + ".tmp";
+    ofstream out(tmpPath, ios::binary | ios::trunc);
+    out.write(spillHeaderBytes(), sizeof(SpillHeader));
+    uint64_t off = sizeof(SpillHeader);
+    vector<pair<SpillRef *, uint64_t>> moved; // new offsets, applied once the file is in place
+    string record;
+    for (auto &sh : shards) {
+        for (auto &kv : sh->spilled) {
+            record.resize(kv.second.bytes);
+            spill.clear();
+            spill.seekg(static_cast<streamoff>(kv.second.offset));
+            if (!spill.read(&record[0], static_cast<streamsize>(record.size()))) break;
+            out.write(record.data(), static_cast<streamsize>(record.size()));
+            moved.push_back({&kv.second, off});
+            off += record.size();
+        }
+    }
+    out.close();
+    error_code ec;
+    if (!spill || !out) {
+        cerr << "Warning: could not compact " << spillPath << ", keeping it as is\n";
+        spill.clear();
+        fs::remove(tmpPath, ec);
+        return;
+    }
+    spill.close();
+    fs::rename(tmpPath, spillPath, ec);
+    if (ec) fs::remove(tmpPath, ec);
+    spill.open(spillPath, ios::in | ios::out | ios::binary);
+    if (!spill.is_open()) {
+        cerr << "Warning: could not reopen " << spillPath << ", idle sessions will stay in memory\n";
+        return;
+    }
+    if (ec) { cerr << "Warning: could not compact " << spillPath << ", keeping it as is\n"; return; }
+    for (auto &m : moved) m.first->offset = m.second;
+    fileBytes = off;
+}
+
+// items are written by category, name and taste, not by index, so a record
+// stays meaningful when the catalog it was written against changes
+string SessionStore::encode(const CompactSession &s) const {
+    string out;
+    putStr(out, s.firstName);
+    putStr(out, s.lastName);
+    putStr(out, s.gender);
+    put(out, static_cast<uint32_t>(s.items.size()));
+    size_t manualIdx = 0;
+    for (const auto &it : s.items) {
+        put(out, static_cast<uint8_t>(it.ref != kManualItem)); // from the catalog
+        put(out, it.options);
+        put(out, it.price);
+        if (it.ref != kManualItem) {
+            CatalogItem ci = catalog.item(it.ref);
+            putStr(out, ci.name);
+            put(out, ci.category);
+            put(out, ci.taste);
+        } else {
+            const ManualItem &m = s.manual[manualIdx++];
+            putStr(out, m.name);
+            put(out, m.category);
+            put(out, m.taste);
+        }
+    }
+    put(out, s.totalCost);
+    put(out, s.tasteSum);
+    return out;
+}
+
+bool SessionStore::decode(const string &bytes, CompactSession &s, size_t &stale) const {
+    Reader r{bytes};
+    s.firstName = r.getStr();
+    s.lastName = r.getStr();
+    s.gender = r.getStr();
+    uint32_t n = r.get<uint32_t>();
+    if (!r.ok || n > bytes.size()) return false;
+    s.items.resize(n);
+    for (auto &it : s.items) {
+        bool fromCatalog = r.get<uint8_t>() != 0;
+        it.options = r.get<uint8_t>();
+        it.price = r.get<double>();
+        ManualItem m;
+        m.name = r.getStr();
+        m.category = r.get<Category>();
+        m.taste = r.get<Taste>();
+        if (!r.ok || m.category >= Category::Unknown) return false;
+        // only the same dish with the same tastes becomes a ref again
+        auto f = fromCatalog ? refByKey.find(refKey(m.category, m.name)) : refByKey.end();
+        if (f != refByKey.end() && catalog.item(f->second).taste == m.taste) {
+            it.ref = f->second;
+        } else {
+            if (fromCatalog && !refByKey.empty()) ++stale; // without a catalog nothing is stale
+            it.ref = kManualItem;
+            s.manual.push_back(std::move(m));
+        }
+    }
+    s.totalCost = r.get<double>();
+    s.tasteSum = r.get<array<float, kTasteDims>>();
+    return r.ok;
+}
+
+} // namespace menu
@@ -0,0 +1,114 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Catalog.hpp"
+#include "Menu.hpp"
+#include "Taste.hpp"
+
+namespace menu {
+
+// ========== SESSION STORE ==========
+// Keeps many diners' User + Menu state in a compact form: catalog items are
+// a 32-bit index into the loaded catalog (a CatalogView) plus their option byte and price,
+// and the menu's total cost / taste sum are kept inline so they can be read
+// without rebuilding the Menu. Sessions are spread over independently locked
+// shards. Idle sessions are appended to a spill file and restored lazily on
+// the next load(). The spill file is re-indexed when a store is opened, so
+// sessions survive a restart. Spilled items carry their category, name and
+// taste rather than an index, so they are looked up again in whatever catalog
+// is loaded then; a dish that left the catalog comes back as a manual item.
+// Superseded records are dropped by rewriting the file once they outweigh the
+// live ones.
+class SessionStore {
+public:
+    using SessionId = std::uint64_t;
+
+    // catalog must outlive the store
+    SessionStore(const CatalogView &catalog, const std::string &spillFile, std::size_t shards = 16);
+
+    // pack user + menu (replaces any previous state of that id)
+    void save(SessionId id, const User &user);
+    // unpack into user; false if the id is unknown
+    bool load(SessionId id, User &user);
+    bool erase(SessionId id);
+    // inline aggregates of a resident or spilled session, without rebuilding the Menu
+    bool summary(SessionId id, double &totalCost, Taste &tasteAvg);
+
+    // move sessions untouched for at least `idle` to the spill file; returns how many
+    std::size_t evictIdle(std::chrono::steady_clock::duration idle);
+    std::size_t evictAll() { return evictIdle(std::chrono::steady_clock::duration::zero()); }
+
+    std::size_t residentCount() const;
+    std::size_t spilledCount() const;
+    std::size_t memoryBytes() const; // approximate, resident sessions only
+
+private:
+    static constexpr std::uint32_t kManualItem = 0xffffffffu;
+
+    struct SessionItem {
+        std::uint32_t ref; // flat catalog index, or kManualItem
+        std::uint8_t options;
+        double price; // exact: the diner sees it again
+    };
+    // items typed in by hand have no catalog index
+    struct ManualItem {
+        std::string name;
+        Category category;
+        Taste taste;
+    };
+    struct CompactSession {
+        std::string firstName, lastName, gender;
+        std::vector<SessionItem> items;
+        std::vector<ManualItem> manual; // in order of the kManualItem entries
+        double totalCost = 0;
+        std::array<float, kTasteDims> tasteSum{}; // only read as an average, so float is enough
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+    struct SpillRef {
+        std::uint64_t offset; // of the record in the spill file
+        std::uint32_t bytes;  // whole record, header included
+    };
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<SessionId, CompactSession> resident;
+        std::unordered_map<SessionId, SpillRef> spilled;
+    };
+    const CatalogView &catalog;
+    std::unordered_map<std::string, std::uint32_t> refByKey;   // "Category\nname" -> index
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::string spillPath;
+    std::fstream spill;
+    std::mutex spillMutex;
+    std::atomic<std::uint64_t> fileBytes{0}; // spill file size
+    std::atomic<std::uint64_t> liveBytes{0}; // records still referenced by a shard
+
+    Shard &shardFor(SessionId id) { return *shards[id % shards.size()]; }
+    CompactSession pack(const User &user) const;
+    void unpack(const CompactSession &s, User &user) const;
+    // caller holds the shard lock; moves a spilled session back into memory
+    bool restore(Shard &shard, SessionId id);
+    void dropSpilled(Shard &shard, SessionId id);
+    std::string encode(const CompactSession &s) const;
+    // stale counts catalog items that no longer resolve and were kept as manual items
+    bool decode(const std::string &bytes, CompactSession &s, std::size_t &stale) const;
+    SpillRef appendRecord(SessionId id, const std::string &bytes);
+    void reindex();
+    // rewrite the spill file with only the live records once they are outweighed by dead ones
+    void maybeCompact();
+    void compact(); // caller holds every shard lock and spillMutex
+};
+
+} // namespace menu
+
+#endif
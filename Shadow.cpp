@@ -0,0 +1,141 @@
+#include "Shadow.hpp"
+#include <algorithm>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include "Serializer.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+
+namespace ai {
+
+// ========== MODEL SET ==========
+ModelSet::ModelSet(const LinearRegression &primary) {
+    add(primary, "primary");
+}
+
+void ModelSet::setColumn(size_t m, const array<double, kDims + 1> &w) {
+    double *block = &weightsT[(m / kBlock) * (kDims + 1) * kBlock];
+    for (size_t r = 0; r <= kDims; ++r) block[r * kBlock + m % kBlock] = w[r];
+}
+
+void ModelSet::add(const LinearRegression &model, string name) {
+    if (names.size() % kBlock == 0) weightsT.resize(weightsT.size() + (kDims + 1) * kBlock, 0.0); // padding columns stay zero
+    names.push_back(move(name));
+    setColumn(names.size() - 1, model.getWeights());
+}
+
+bool ModelSet::addFromFile(const string &filename) {
+    ifstream file(filename);
+    json j = file.is_open() ? json::parse(file, nullptr, false) : json();
+    if (!j.is_object() || !j.contains("weights") || !j["weights"].is_array()) {
+        cerr << "Warning: " << filename << " has no weights, shadow model skipped\n";
+        return false;
+    }
+    if (j["weights"].size() != kDims + 1) {
+        // e.g. a model_selection.json winner with interaction features
+        cerr << "Warning: " << filename << " has " << j["weights"].size() << " weights, the bot's model has "
+             << kDims + 1 << "; shadow model skipped\n";
+        return false;
+    }
+    LinearRegression model;
+    model.loadWeights(filename);
+    add(model, filename);
+    return true;
+}
+
+void ModelSet::setPrimary(const LinearRegression &model) { setColumn(0, model.getWeights()); }
+
+void ModelSet::scoreAll(const double *x, double *out) const {
+    const double *block = weightsT.data();
+    for (size_t m0 = 0; m0 < names.size(); m0 += kBlock, block += (kDims + 1) * kBlock) {
+        double acc[kBlock];
+        for (size_t j = 0; j < kBlock; ++j) acc[j] = block[j]; // bias row
+        for (size_t d = 0; d < kDims; ++d)
+            for (size_t j = 0; j < kBlock; ++j) acc[j] += block[(d + 1) * kBlock + j] * x[d];
+        copy_n(acc, min(kBlock, names.size() - m0), out + m0);
+    }
+}
+
+// ========== RECORDS ==========
+static void appendJsonArray(string &out, const vector<double> &v) {
+    out += '[';
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (i) out += ',';
+        menu::appendJsonNumber(out, v[i]);
+    }
+    out += ']';
+}
+
+void writeShadowRecord(string &out, uint64_t request, string_view mode, const ShadowRecord &r, const ModelSet &models) {
+    out += "{\"request\":";
+    menu::appendNumber(out, static_cast<size_t>(request));
+    out += ",\"mode\":";
+    menu::appendJsonString(out, mode);
+    out += ",\"models\":[";
+    for (size_t m = 0; m < models.size(); ++m) {
+        if (m) out += ',';
+        menu::appendJsonString(out, models.name(m));
+    }
+    out += "],\"served\":";
+    appendJsonArray(out, r.served);
+    if (!r.best.empty()) {
+        out += ",\"best\":";
+        appendJsonArray(out, r.best);
+        out += ",\"agree\":[";
+        for (size_t m = 0; m < r.agree.size(); ++m) {
+            if (m) out += ',';
+            out += r.agree[m] ? "true" : "false";
+        }
+        out += ']';
+    }
+    out += "}\n";
+}
+
+void writeShadowRating(string &out, uint64_t request, double rating) {
+    out += "{\"request\":";
+    menu::appendNumber(out, static_cast<size_t>(request));
+    out += ",\"rating\":";
+    menu::appendJsonNumber(out, rating);
+    out += "}\n";
+}
+
+// ========== ASYNC LOG ==========
+ShadowLog::ShadowLog(const string &filename, size_t maxPending) : out(filename, ios::app), maxPending(maxPending) {
+    if (!out.is_open()) { cerr << "Warning: could not open " << filename << " for the shadow log\n"; return; }
+    worker = thread(&ShadowLog::run, this);
+}
+
+ShadowLog::~ShadowLog() {
+    if (!worker.joinable()) return;
+    { lock_guard<mutex> lock(m); stopping = true; }
+    cv.notify_one();
+    worker.join();
+}
+
+void ShadowLog::write(string_view lines) {
+    if (!isOpen()) return;
+    {
+        lock_guard<mutex> lock(m);
+        if (pending.size() + lines.size() > maxPending) { ++droppedWrites; return; }
+        pending.append(lines.data(), lines.size());
+    }
+    cv.notify_one();
+}
+
+void ShadowLog::run() {
+    string writing; // swapped with pending, so the lock is never held during I/O
+    unique_lock<mutex> lock(m);
+    while (true) {
+        cv.wait(lock, [&] { return stopping || !pending.empty(); });
+        if (pending.empty() && stopping) break;
+        writing.swap(pending);
+        lock.unlock();
+        out.write(writing.data(), static_cast<streamsize>(writing.size()));
+        out.flush();
+        writing.clear();
+        lock.lock();
+    }
+}
+
+} // namespace ai
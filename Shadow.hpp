@@ -0,0 +1,90 @@
+#ifndef SHADOW_HPP
+#define SHADOW_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "AI.hpp"
+
+namespace ai {
+
+// ========== SHADOW MODELS ==========
+// The primary model plus any number of shadow models, kept as one weights
+// matrix. It is stored transposed, in blocks of kBlock models: each block is
+// (kTasteDims + 1) rows of kBlock weights, so scoring a taste vector is one
+// pass over its dimensions that updates a whole block of scores at once.
+// Only the primary's score is used; the shadows' scores are logged for
+// offline comparison.
+class ModelSet {
+public:
+    static constexpr std::size_t kDims = menu::kTasteDims;
+    static constexpr std::size_t kBlock = 4; // models per kernel block (padding unit)
+
+    explicit ModelSet(const LinearRegression &primary);
+
+    void add(const LinearRegression &model, std::string name);
+    // loads a weights file (weights.json format); false with a warning if unusable
+    bool addFromFile(const std::string &filename);
+    void setPrimary(const LinearRegression &model); // column 0, e.g. after training
+
+    std::size_t size() const { return names.size(); } // primary included
+    const std::string &name(std::size_t m) const { return names[m]; }
+
+    // out[m] = bias_m + w_m . x for every model, primary first; out holds size() values
+    void scoreAll(const double *x, double *out) const;
+
+private:
+    void setColumn(std::size_t m, const std::array<double, kDims + 1> &w);
+
+    std::vector<double> weightsT; // per block: bias row, then one row per dimension, kBlock models wide
+    std::vector<std::string> names;
+};
+
+// what every model made of one request
+struct ShadowRecord {
+    std::vector<double> served;       // each model's score of the menu that was served
+    std::vector<double> best;         // each model's best score over the candidates (Random+AI)
+    std::vector<std::uint8_t> agree;  // the model's own pick was the served menu (Random+AI)
+};
+
+// {"request":n,"mode":"...","models":[...],"served":[...],"best":[...],"agree":[...]}
+void writeShadowRecord(std::string &out, std::uint64_t request, std::string_view mode, const ShadowRecord &r, const ModelSet &models);
+// {"request":n,"rating":r}, joined with the record offline
+void writeShadowRating(std::string &out, std::uint64_t request, double rating);
+
+// Appends lines to a file from a background thread. write() only copies into
+// a pending buffer; once that backlog passes maxPending bytes, lines are
+// dropped (and counted) instead of making the request wait for the disk.
+class ShadowLog {
+public:
+    explicit ShadowLog(const std::string &filename, std::size_t maxPending = std::size_t(4) << 20);
+    ~ShadowLog(); // writes whatever is pending
+    ShadowLog(const ShadowLog &) = delete;
+    ShadowLog &operator=(const ShadowLog &) = delete;
+
+    bool isOpen() const { return out.is_open(); }
+    void write(std::string_view lines);
+    std::uint64_t dropped() const { return droppedWrites.load(); }
+
+private:
+    void run();
+
+    std::ofstream out;
+    std::size_t maxPending;
+    std::mutex m;
+    std::condition_variable cv;
+    std::string pending;
+    bool stopping = false;
+    std::atomic<std::uint64_t> droppedWrites{0};
+    std::thread worker;
+};
+
+} // namespace ai
+
+#endif
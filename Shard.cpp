@@ -0,0 +1,434 @@
+#include "Shard.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "AllocTracker.hpp"
+#include "Catalog.hpp"
+
+using namespace std;
+
+namespace menu {
+
+// ========== WIRE FORMAT ==========
+// fixed-size request; replies are a byte count followed by that many bytes.
+// Both sides are the same binary, so structs go over the socket as-is.
+enum : uint32_t { kOpQuery = 1, kOpStop = 2, kOpList = 3 };
+constexpr uint32_t kNoGroup = numeric_limits<uint32_t>::max();
+
+struct QueryMsg {
+    uint32_t op;
+    uint32_t group; // kOpList: the worker's own group index, kNoGroup if it has none
+    uint8_t preferVeg;
+    double profile[kTasteDims];
+};
+
+// one candidate of a query reply or item of a list reply, followed by nameLen bytes of name
+struct WireCandidate {
+    double dist2;
+    double price;
+    double taste[kTasteDims];
+    uint64_t order;   // catalog position: (source file << 32) | first index in its category
+    uint32_t group;   // the worker's own group index
+    uint32_t nameLen;
+    uint8_t veg;
+    uint8_t vegFlagged; // explicit "vegetarian" flag in the entry
+};
+
+static bool writeAll(int fd, const void *buf, size_t n) {
+    auto p = static_cast<const char *>(buf);
+    while (n > 0) {
+        ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w; n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+static bool readAll(int fd, void *buf, size_t n) {
+    auto p = static_cast<char *>(buf);
+    while (n > 0) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r; n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+// skips n bytes without allocating
+static bool discard(int fd, size_t n) {
+    char buf[4096];
+    while (n > 0) {
+        size_t k = min(n, sizeof(buf));
+        if (!readAll(fd, buf, k)) return false;
+        n -= k;
+    }
+    return true;
+}
+
+template <class T>
+static void put(string &out, const T &v) { out.append(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+// ========== WORKER ==========
+namespace {
+
+struct ShardItem {
+    uint32_t group;
+    uint8_t veg, vegFlagged, mainCourse;
+    uint64_t order;
+    double price;
+    Taste taste;
+    string name;
+};
+
+// every copy of a named entry goes to the same shard, so duplicates are merged there;
+// nameless entries are never merged and are spread by position
+size_t ownerOf(const string &category, const string &key, uint64_t order, ShardBy by, size_t shards) {
+    if (by == ShardBy::Category) {
+        Category c = findCategory(category);
+        return c != Category::Unknown ? static_cast<size_t>(c) % shards : hash<string>()(category) % shards;
+    }
+    if (key.empty()) return static_cast<size_t>(order % shards);
+    return hash<string>()(category + '\n' + key) % shards;
+}
+
+// reads every source, one parsed file at a time, and keeps this shard's entries
+// under the same rules as loadCatalogFiles; shard 0 reports unreadable files
+vector<ShardItem> loadSlice(const vector<string> &sources, size_t shard, size_t shards, ShardBy by, vector<string> &groups,
+                            CatalogLoadStats &stats) {
+    vector<ShardItem> items;
+    map<string, uint32_t> groupIndex;
+    unordered_map<string, size_t> byKey; // "category\nkey" -> items index
+    stats.files = sources.size();
+    for (size_t f = 0; f < sources.size(); ++f) {
+        ifstream file(sources[f]);
+        if (!file.is_open()) {
+            if (shard == 0) cerr << "Warning: could not open catalog file " + sources[f] + "\n";
+            continue;
+        }
+        json doc = json::parse(file, nullptr, false);
+        if (doc.is_discarded() || !doc.is_object()) {
+            if (shard == 0) cerr << "Warning: " + sources[f] + " is not a JSON object of categories, skipped\n";
+            continue;
+        }
+        ++stats.parsed;
+        Catalog part = groupByCategory(move(doc));
+        for (auto &[category, entries] : part) {
+            bool mainCourse = findCategory(category) == Category::MainCourse;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const json &it = entries[i];
+                string key = catalogEntryKey(it);
+                uint64_t order = (static_cast<uint64_t>(f) << 32) | i;
+                if (ownerOf(category, key, order, by, shards) != shard) continue;
+                auto g = groupIndex.emplace(category, static_cast<uint32_t>(groups.size()));
+                if (g.second) groups.push_back(category);
+                auto flag = it.find("vegetarian");
+                ShardItem item{g.first->second, static_cast<uint8_t>(isVegetarianEntry(it)),
+                               static_cast<uint8_t>(flag != it.end() && flag->is_boolean()), static_cast<uint8_t>(mainCourse),
+                               order, it.value("price", 0.0), parseTasteFromJson(it), it.value("name", string())};
+                if (key.empty()) { items.push_back(move(item)); continue; }
+                auto [pos, added] = byKey.emplace(category + '\n' + key, items.size());
+                if (added) items.push_back(move(item));
+                else { item.order = items[pos->second].order; items[pos->second] = move(item); ++stats.duplicates; } // replaced in place
+            }
+        }
+    }
+    stats.items = items.size();
+    return items;
+}
+
+// nearer, or as near and earlier in catalog order
+bool closer(double d, const ShardItem &a, double bestD, const ShardItem &b) {
+    return d < bestD || (d == bestD && a.order < b.order);
+}
+
+void appendCandidate(string &out, const ShardItem &it, double dist2) {
+    WireCandidate w{};
+    w.dist2 = dist2;
+    w.price = it.price;
+    copy(it.taste.begin(), it.taste.end(), w.taste);
+    w.order = it.order;
+    w.group = it.group;
+    w.nameLen = static_cast<uint32_t>(it.name.size());
+    w.veg = it.veg;
+    w.vegFlagged = it.vegFlagged;
+    put(out, w);
+    out += it.name;
+}
+
+[[noreturn]] void runWorker(int fd, vector<ShardItem> items, const vector<string> &groups, const CatalogLoadStats &stats) {
+    // ready: [u32 items][u32 files parsed][u32 duplicates][u32 groups]{[u32 length][name]}
+    string out;
+    put(out, static_cast<uint32_t>(items.size()));
+    put(out, static_cast<uint32_t>(stats.parsed));
+    put(out, static_cast<uint32_t>(stats.duplicates));
+    put(out, static_cast<uint32_t>(groups.size()));
+    for (auto &g : groups) { put(out, static_cast<uint32_t>(g.size())); out += g; }
+    if (!writeAll(fd, out.data(), out.size())) _exit(1);
+
+    // per group: the nearest item, and the nearest vegetarian main course when asked for
+    constexpr uint32_t kNone = numeric_limits<uint32_t>::max();
+    vector<uint32_t> best(groups.size()), bestVeg(groups.size());
+    vector<double> bestDist(groups.size()), bestVegDist(groups.size());
+    QueryMsg q;
+    while (readAll(fd, &q, sizeof(q)) && (q.op == kOpQuery || q.op == kOpList)) {
+        out.clear();
+        if (q.op == kOpList) {
+            // every item of one group, in any order; the coordinator sorts them
+            for (const auto &it : items)
+                if (it.group == q.group) appendCandidate(out, it, 0);
+            uint32_t n = static_cast<uint32_t>(out.size());
+            if (!writeAll(fd, &n, sizeof(n)) || !writeAll(fd, out.data(), n)) break;
+            continue;
+        }
+        fill(best.begin(), best.end(), kNone);
+        fill(bestVeg.begin(), bestVeg.end(), kNone);
+        for (uint32_t i = 0; i < items.size(); ++i) {
+            const auto &it = items[i];
+            double d = distance2<kTasteDims>(q.profile, it.taste.data());
+            uint32_t g = it.group;
+            if (best[g] == kNone || closer(d, it, bestDist[g], items[best[g]])) { best[g] = i; bestDist[g] = d; }
+            // kept apart so the coordinator can still apply the veg filter after merging
+            if (q.preferVeg && it.mainCourse && it.veg && (bestVeg[g] == kNone || closer(d, it, bestVegDist[g], items[bestVeg[g]]))) {
+                bestVeg[g] = i;
+                bestVegDist[g] = d;
+            }
+        }
+        for (size_t g = 0; g < groups.size(); ++g) {
+            if (best[g] != kNone) appendCandidate(out, items[best[g]], bestDist[g]);
+            if (bestVeg[g] != kNone) appendCandidate(out, items[bestVeg[g]], bestVegDist[g]);
+        }
+        uint32_t n = static_cast<uint32_t>(out.size());
+        if (!writeAll(fd, &n, sizeof(n)) || !writeAll(fd, out.data(), n)) break;
+    }
+    ::close(fd);
+    _exit(0);
+}
+
+} // namespace
+
+// ========== COORDINATOR ==========
+ShardedCatalog::ShardedCatalog(const vector<string> &sources, size_t shards, ShardBy by) {
+    shards = max<size_t>(1, shards);
+
+    cout.flush(); // children must not inherit pending output
+    cerr.flush();
+    for (size_t s = 0; s < shards; ++s) {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) { stop(); throw runtime_error("socketpair failed"); }
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            ::close(fds[0]); ::close(fds[1]);
+            stop();
+            throw runtime_error("fork failed");
+        }
+        if (pid == 0) {
+            ::close(fds[0]);
+            for (auto &w : workers) ::close(w.fd);
+            vector<ShardItem> items;
+            vector<string> groups;
+            CatalogLoadStats stats;
+            try {
+                items = loadSlice(sources, s, shards, by, groups, stats);
+            } catch (const std::exception &e) {
+                cerr << "Shard " << s << " failed to load: " << e.what() << "\n";
+                _exit(1); // never unwind back into the coordinator's main()
+            }
+            runWorker(fds[1], std::move(items), groups, stats);
+        }
+        ::close(fds[1]);
+        workers.push_back({pid, fds[0], {}, {}});
+    }
+
+    // the shards load in parallel; each reports its items and groups when ready
+    vector<vector<string>> local(workers.size());
+    loaded.files = sources.size();
+    for (size_t w = 0; w < workers.size(); ++w) {
+        uint32_t n = 0, parsed = 0, duplicates = 0, count = 0;
+        bool ok = readAll(workers[w].fd, &n, sizeof(n)) && readAll(workers[w].fd, &parsed, sizeof(parsed)) &&
+                  readAll(workers[w].fd, &duplicates, sizeof(duplicates)) && readAll(workers[w].fd, &count, sizeof(count));
+        for (uint32_t g = 0; ok && g < count; ++g) {
+            uint32_t len = 0;
+            ok = readAll(workers[w].fd, &len, sizeof(len));
+            string name(ok ? len : 0, '\0');
+            ok = ok && readAll(workers[w].fd, &name[0], len);
+            local[w].push_back(move(name));
+        }
+        if (!ok) { stop(); throw runtime_error("a shard failed to load the catalog"); }
+        loaded.items += n;
+        loaded.parsed = parsed; // every shard reads every file
+        loaded.duplicates += duplicates;
+        groupNames.insert(groupNames.end(), local[w].begin(), local[w].end());
+    }
+    sort(groupNames.begin(), groupNames.end());
+    groupNames.erase(unique(groupNames.begin(), groupNames.end()), groupNames.end());
+    for (size_t w = 0; w < workers.size(); ++w)
+        for (auto &g : local[w])
+            workers[w].groups.push_back(static_cast<uint32_t>(lower_bound(groupNames.begin(), groupNames.end(), g) - groupNames.begin()));
+
+    if (loaded.parsed) {
+        string missing;
+        for (const auto &info : kCategories)
+            if (!binary_search(groupNames.begin(), groupNames.end(), string(info.name)))
+                missing += (missing.empty() ? "" : ", ") + string(info.name);
+        if (!missing.empty()) cerr << "Warning: the catalog has no items for: " << missing << "\n";
+    }
+}
+
+ShardedCatalog::~ShardedCatalog() { stop(); }
+
+void ShardedCatalog::stop() {
+    QueryMsg q{};
+    q.op = kOpStop;
+    for (auto &w : workers) {
+        writeAll(w.fd, &q, sizeof(q));
+        ::close(w.fd);
+        ::waitpid(w.pid, nullptr, 0);
+    }
+    workers.clear();
+}
+
+// reads one reply from every worker into its reply buffer
+void ShardedCatalog::gather() {
+    exception_ptr failure;
+    for (auto &wk : workers) {
+        wk.reply.clear();
+        uint32_t n = 0;
+        if (!readAll(wk.fd, &n, sizeof(n))) { cerr << "Warning: lost shard " << wk.pid << "\n"; continue; }
+        try {
+            wk.reply.resize(n);
+        } catch (...) {
+            failure = current_exception();
+            discard(wk.fd, n);
+            continue;
+        }
+        if (!readAll(wk.fd, &wk.reply[0], n)) { cerr << "Warning: lost shard " << wk.pid << "\n"; wk.reply.clear(); }
+    }
+    if (failure) rethrow_exception(failure);
+}
+
+vector<ShardedCatalog::Candidate> ShardedCatalog::query(const Taste &profile, bool preferVeg) {
+    AllocPhaseScope phase(AllocPhase::Candidates);
+    QueryMsg q{};
+    q.op = kOpQuery;
+    q.preferVeg = preferVeg;
+    copy(profile.begin(), profile.end(), q.profile);
+
+    // the merge slots are allocated before the fan-out; a reply buffer that fails to grow
+    // (e.g. under an allocation budget) is skipped, and the rethrow waits until every
+    // socket is drained so no reply is left unread
+    struct Pick {
+        WireCandidate c;
+        const char *name;
+        bool set;
+    };
+    vector<Pick> best(groupNames.size(), Pick{}), bestVeg(groupNames.size(), Pick{});
+    auto better = [](const WireCandidate &a, const Pick &b) {
+        // nearest first, then catalog order, like the single-process scan
+        return !b.set || a.dist2 < b.c.dist2 || (a.dist2 == b.c.dist2 && a.order < b.c.order);
+    };
+
+    // fan out first so the shards scan in parallel, then gather
+    for (auto &wk : workers)
+        if (!writeAll(wk.fd, &q, sizeof(q))) cerr << "Warning: shard " << wk.pid << " is not responding\n";
+
+    gather();
+
+    for (auto &wk : workers) {
+        const char *p = wk.reply.data(), *end = p + wk.reply.size();
+        while (end - p >= static_cast<ptrdiff_t>(sizeof(WireCandidate))) {
+            Pick c{{}, p + sizeof(WireCandidate), true};
+            memcpy(&c.c, p, sizeof(WireCandidate));
+            p += sizeof(WireCandidate) + c.c.nameLen;
+            if (p > end) break;
+            uint32_t g = wk.groups[c.c.group];
+            if (better(c.c, best[g])) best[g] = c;
+            if (c.c.veg && better(c.c, bestVeg[g])) bestVeg[g] = c;
+        }
+    }
+
+    vector<Candidate> merged;
+    for (uint32_t g = 0; g < groupNames.size(); ++g) {
+        bool filter = preferVeg && findCategory(groupNames[g]) == Category::MainCourse;
+        // same fallback as the single-process path: no veg item at all -> nearest overall
+        const Pick &c = (filter && bestVeg[g].set) ? bestVeg[g] : best[g];
+        if (!c.set) continue;
+        Taste t;
+        copy(c.c.taste, c.c.taste + kTasteDims, t.begin());
+        merged.push_back({groupNames[g], string(c.name, c.c.nameLen), c.c.price, t, c.c.veg != 0, c.c.dist2});
+    }
+    return merged;
+}
+
+vector<shared_ptr<MenuItem>> ShardedCatalog::suggestByTasteProfile(const Taste &profile, bool preferVeg) {
+    auto picks = query(profile, preferVeg);
+    AllocPhaseScope phase(AllocPhase::MakeItem);
+    vector<shared_ptr<MenuItem>> menu;
+    for (const auto &c : picks) menu.push_back(makeItem(findCategory(c.group), c.name, c.price, c.taste, c.veg));
+    return menu;
+}
+
+vector<CatalogItem> ShardedCatalog::list(const string &group) {
+    auto g = lower_bound(groupNames.begin(), groupNames.end(), group);
+    if (g == groupNames.end() || *g != group) return {};
+    uint32_t global = static_cast<uint32_t>(g - groupNames.begin());
+    Category category = findCategory(group);
+
+    for (auto &wk : workers) {
+        QueryMsg q{};
+        q.op = kOpList;
+        auto local = find(wk.groups.begin(), wk.groups.end(), global);
+        q.group = local == wk.groups.end() ? kNoGroup : static_cast<uint32_t>(local - wk.groups.begin());
+        if (!writeAll(wk.fd, &q, sizeof(q))) cerr << "Warning: shard " << wk.pid << " is not responding\n";
+    }
+    gather();
+
+    vector<pair<uint64_t, CatalogItem>> found;
+    for (auto &wk : workers) {
+        const char *p = wk.reply.data(), *end = p + wk.reply.size();
+        while (end - p >= static_cast<ptrdiff_t>(sizeof(WireCandidate))) {
+            WireCandidate c;
+            memcpy(&c, p, sizeof(WireCandidate));
+            const char *name = p + sizeof(WireCandidate);
+            p = name + c.nameLen;
+            if (p > end) break;
+            Taste t;
+            copy(c.taste, c.taste + kTasteDims, t.begin());
+            found.push_back({c.order, {category, string(name, c.nameLen), c.price, t, c.veg != 0, c.vegFlagged != 0}});
+        }
+    }
+    sort(found.begin(), found.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    vector<CatalogItem> items;
+    items.reserve(found.size());
+    for (auto &f : found) items.push_back(move(f.second));
+    return items;
+}
+
+// ========== CATALOG VIEW ==========
+pair<size_t, size_t> ShardedCatalogView::groupRange(const string &key) const {
+    auto known = ranges.find(key);
+    if (known != ranges.end()) return known->second;
+    size_t begin = listed.size();
+    for (auto &it : shards.list(key)) listed.push_back(move(it));
+    return ranges[key] = {begin, listed.size()};
+}
+
+shared_ptr<MenuItem> ShardedCatalogView::makeItem(size_t idx) const {
+    const CatalogItem &it = listed[idx];
+    return menu::makeItem(it.category, it.name, it.price, it.taste, it.vegetarian);
+}
+
+} // namespace menu
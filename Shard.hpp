@@ -0,0 +1,98 @@
+#ifndef SHARD_HPP
+#define SHARD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "Catalog.hpp"
+#include "Menu.hpp"
+#include "Taste.hpp"
+
+namespace menu {
+
+enum class ShardBy { Hash, Category };
+
+// ========== SHARDED CATALOG ==========
+// Splits the catalog over N forked worker processes (Linux/POSIX), each
+// talking to the coordinator over a unix socketpair. The workers are forked
+// before anything is loaded and read the catalog files themselves, one parsed
+// file at a time, keeping only their own items (name, price, taste, veg).
+// Items go to a shard by (category, name) hash or by category, so every copy
+// of an entry lands on the same shard and the multi-file merge rules hold
+// per shard. A taste-profile query is sent to every shard at once; each shard
+// scans only its own items and answers with its nearest item per catalog
+// group (plus the nearest vegetarian main course when asked), carrying the
+// squared distance and what is needed to serve the item. The coordinator
+// keeps the nearest answer per group. Equal distances go to the item that
+// comes first in catalog order, so the menu matches the single-process
+// suggestByTasteProfile over the same files. The coordinator holds no items:
+// it asks the shards for one group's items when a diner browses it.
+class ShardedCatalog {
+public:
+    // the best candidate of one catalog group
+    struct Candidate {
+        std::string group; // catalog key
+        std::string name;
+        double price;
+        Taste taste;
+        bool veg;
+        double dist2;
+    };
+
+    // forks the workers and waits until each has loaded its slice of `sources`
+    // (see catalogSources); throws std::runtime_error if that fails
+    ShardedCatalog(const std::vector<std::string> &sources, std::size_t shards, ShardBy by);
+    ~ShardedCatalog(); // stops and reaps the workers
+    ShardedCatalog(const ShardedCatalog &) = delete;
+    ShardedCatalog &operator=(const ShardedCatalog &) = delete;
+
+    // fan out, merge, and return the best candidate of each group (same order as a Catalog)
+    std::vector<Candidate> query(const Taste &profile, bool preferVeg);
+    std::vector<std::shared_ptr<MenuItem>> suggestByTasteProfile(const Taste &profile, bool preferVeg);
+    // every item of one group (normalized category name), in catalog order
+    std::vector<CatalogItem> list(const std::string &group);
+
+    std::size_t shardCount() const { return workers.size(); }
+    std::size_t itemCount() const { return loaded.items; }
+    // as loadCatalogFiles reports it; duplicates are summed over the shards
+    const CatalogLoadStats &loadStats() const { return loaded; }
+
+private:
+    struct Worker {
+        pid_t pid;
+        int fd;
+        std::vector<std::uint32_t> groups; // the worker's group index -> index in groupNames
+        std::string reply;                 // last reply, reused across queries
+    };
+
+    std::vector<std::string> groupNames; // every group any shard holds, sorted like a Catalog
+    std::vector<Worker> workers;
+    CatalogLoadStats loaded;
+
+    void gather();
+    void stop();
+};
+
+// CatalogView over the shards for interact: a group's items are fetched when it is
+// first asked for and get flat indices in that order; groups never asked for have none
+class ShardedCatalogView : public CatalogView {
+public:
+    explicit ShardedCatalogView(ShardedCatalog &shards) : shards(shards) {}
+    std::size_t itemCount() const override { return listed.size(); }
+    std::pair<std::size_t, std::size_t> groupRange(const std::string &key) const override;
+    CatalogItem item(std::size_t idx) const override { return listed[idx]; }
+    std::shared_ptr<MenuItem> makeItem(std::size_t idx) const override;
+
+private:
+    ShardedCatalog &shards;
+    mutable std::vector<CatalogItem> listed;
+    mutable std::map<std::string, std::pair<std::size_t, std::size_t>> ranges;
+};
+
+} // namespace menu
+
+#endif
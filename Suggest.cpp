@@ -0,0 +1,210 @@
+#include "Suggest.hpp"
+#include <algorithm>
+#include <limits>
+#include <random>
+#include "AllocTracker.hpp"
+
+using namespace std;
+
+namespace menu {
+
+Taste tasteVectorFromMenu(const vector<shared_ptr<MenuItem>> &menu) {
+    if (menu.empty()) return neutralTaste();
+    Taste avg{};
+    for (auto &it : menu) addTaste(avg, it->getTaste());
+    for (auto &v : avg) v /= menu.size();
+    return avg;
+}
+
+Taste tasteVectorFromMenu(const Menu &m) {
+    return m.getTasteAvg();
+}
+
+// generate many random candidate full-menus and pick the one with highest predicted satisfaction;
+// score(taste) rates one candidate
+template <class Score>
+static vector<shared_ptr<MenuItem>> randomMenuBest(const Catalog &catalog, bool preferVeg, int samples, Score score) {
+    AllocPhaseScope phase(AllocPhase::Candidates);
+    vector<shared_ptr<MenuItem>> bestMenu;
+    double bestScore = std::numeric_limits<double>::lowest();
+    random_device rd; mt19937 gen(rd());
+    for (int s=0;s<samples;++s) {
+        vector<shared_ptr<MenuItem>> cand;
+        for (auto &kv : catalog) {
+            const auto &vec = kv.second;
+            if (vec.empty()) continue;
+            Category cat = findCategory(kv.first);
+
+            vector<size_t> candidates;
+            for (size_t i=0;i<vec.size();++i) {
+                const json &entry = vec[i];
+                if (cat == Category::MainCourse && preferVeg && !isVegetarianEntry(entry)) continue;
+                candidates.push_back(i);
+            }
+
+            if (candidates.empty()) {
+                for (size_t i=0;i<vec.size();++i) candidates.push_back(i);
+            }
+
+            uniform_int_distribution<size_t> dist(0, candidates.size()-1);
+            size_t chosen = candidates[dist(gen)];
+            cand.push_back(makeItemFromJson(cat, vec[chosen]));
+        }
+        if (cand.empty()) continue;
+        double sc = score(tasteVectorFromMenu(cand));
+        if (sc > bestScore) { bestScore = sc; bestMenu = cand; }
+    }
+    return bestMenu;
+}
+
+vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const Catalog &catalog, const ai::LinearRegression &model, bool preferVeg, int samples) {
+    return randomMenuBest(catalog, preferVeg, samples, [&](const Taste &t) { return model.predict(t); });
+}
+
+namespace {
+// scores each candidate with every model in one pass; the primary (model 0) still
+// picks, and each model's own best is tracked alongside
+struct ShadowTracker {
+    const ai::ModelSet &models;
+    ai::ShadowRecord &record;
+    vector<double> scores;
+    vector<int> bestAt;
+    int sample = 0;
+
+    ShadowTracker(const ai::ModelSet &ms, ai::ShadowRecord &r) : models(ms), record(r), scores(ms.size()), bestAt(ms.size(), -1) {
+        record.served.assign(ms.size(), 0.0);
+        record.best.assign(ms.size(), std::numeric_limits<double>::lowest());
+        record.agree.clear();
+    }
+    double operator()(const Taste &t) {
+        models.scoreAll(t.data(), scores.data());
+        for (size_t m = 0; m < scores.size(); ++m)
+            if (scores[m] > record.best[m]) { record.best[m] = scores[m]; bestAt[m] = sample; }
+        if (bestAt[0] == sample) record.served = scores; // the primary's new pick
+        ++sample;
+        return scores[0];
+    }
+    void finish() {
+        record.agree.resize(bestAt.size());
+        for (size_t m = 0; m < bestAt.size(); ++m) record.agree[m] = bestAt[m] == bestAt[0];
+    }
+};
+} // namespace
+
+vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const Catalog &catalog, const ai::ModelSet &models, bool preferVeg, int samples, ai::ShadowRecord &record) {
+    ShadowTracker track(models, record);
+    auto menu = randomMenuBest(catalog, preferVeg, samples, [&](const Taste &t) { return track(t); });
+    track.finish();
+    return menu;
+}
+
+vector<shared_ptr<MenuItem>> suggestByTasteProfile(const Catalog &catalog, const Taste &profile, bool preferVeg) {
+    AllocPhaseScope phase(AllocPhase::Candidates);
+    vector<shared_ptr<MenuItem>> menu;
+    for (auto &kv : catalog) {
+        const auto &vec = kv.second;
+        if (vec.empty()) continue;
+        Category cat = findCategory(kv.first);
+        double bestDist = 1e18;
+        int bestIdx = -1;
+        for (size_t i = 0; i < vec.size(); ++i) {
+            const json &candidate = vec[i];
+            if (cat == Category::MainCourse && preferVeg && !isVegetarianEntry(candidate)) continue; // skip non-veg
+            double d = euclidean(parseTasteFromJson(candidate), profile);
+            if (d < bestDist) { bestDist = d; bestIdx = static_cast<int>(i); }
+        }
+        if (bestIdx >= 0) menu.push_back(makeItemFromJson(cat, vec[bestIdx]));
+        else {
+            auto fallback = min_element(vec.begin(), vec.end(), [&](const json &a, const json &b){
+                return euclidean(parseTasteFromJson(a), profile) < euclidean(parseTasteFromJson(b), profile);
+            });
+            if (fallback != vec.end()) menu.push_back(makeItemFromJson(cat, *fallback));
+        }
+    }
+    return menu;
+}
+
+// same as randomMenuBest, over quantized storage; score(items) rates one candidate
+template <class Q, class Score>
+static vector<shared_ptr<MenuItem>> compactRandomMenuBest(const CompactCatalog<Q> &catalog, bool preferVeg, int samples, Score score) {
+    AllocPhaseScope phase(AllocPhase::Candidates);
+    const auto &groups = catalog.getGroups();
+
+    // eligible items per group, computed once instead of per sample
+    vector<vector<uint32_t>> eligible(groups.size());
+    for (size_t g=0; g<groups.size(); ++g) {
+        for (uint32_t i=groups[g].begin; i<groups[g].end; ++i) {
+            if (groups[g].id == Category::MainCourse && preferVeg && !catalog.isVegetarian(i)) continue;
+            eligible[g].push_back(i);
+        }
+        if (eligible[g].empty())
+            for (uint32_t i=groups[g].begin; i<groups[g].end; ++i) eligible[g].push_back(i);
+    }
+
+    vector<uint32_t> best, cand;
+    double bestScore = std::numeric_limits<double>::lowest();
+    random_device rd; mt19937 gen(rd());
+    for (int s=0;s<samples;++s) {
+        cand.clear();
+        for (auto &idx : eligible) {
+            if (idx.empty()) continue;
+            uniform_int_distribution<size_t> dist(0, idx.size()-1);
+            cand.push_back(idx[dist(gen)]);
+        }
+        if (cand.empty()) continue;
+        double sc = score(cand);
+        if (sc > bestScore) { bestScore = sc; best = cand; }
+    }
+
+    vector<shared_ptr<MenuItem>> bestMenu;
+    for (size_t g=0, k=0; g<groups.size() && k<best.size(); ++g)
+        if (!eligible[g].empty()) bestMenu.push_back(catalog.makeItem(groups[g], best[k++]));
+    return bestMenu;
+}
+
+// The model is linear, so a menu's score is bias + mean of per-item (w . taste); no taste vectors are built.
+template <class Q>
+vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog<Q> &catalog, const ai::LinearRegression &model, bool preferVeg, int samples) {
+    const auto &w = model.getWeights();
+    return compactRandomMenuBest(catalog, preferVeg, samples, [&](const vector<uint32_t> &cand) {
+        double sum = 0;
+        for (uint32_t i : cand) sum += catalog.dot(i, &w[1]);
+        return w[0] + sum / cand.size();
+    });
+}
+
+// with shadows the candidate's mean taste is decoded once and handed to the fused kernel
+template <class Q>
+vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog<Q> &catalog, const ai::ModelSet &models, bool preferVeg, int samples, ai::ShadowRecord &record) {
+    ShadowTracker track(models, record);
+    auto menu = compactRandomMenuBest(catalog, preferVeg, samples, [&](const vector<uint32_t> &cand) {
+        Taste avg{};
+        for (uint32_t i : cand) addTaste(avg, catalog.getTaste(i));
+        for (auto &v : avg) v /= cand.size();
+        return track(avg);
+    });
+    track.finish();
+    return menu;
+}
+
+template <class Q>
+vector<shared_ptr<MenuItem>> suggestByTasteProfile(const CompactCatalog<Q> &catalog, const Taste &profile, bool preferVeg) {
+    AllocPhaseScope phase(AllocPhase::Candidates);
+    vector<shared_ptr<MenuItem>> menu;
+    for (auto &g : catalog.getGroups()) {
+        if (g.begin == g.end) continue;
+        long best = catalog.nearest(g, profile.data(), g.id == Category::MainCourse && preferVeg);
+        if (best < 0) best = catalog.nearest(g, profile.data(), false);
+        menu.push_back(catalog.makeItem(g, static_cast<size_t>(best)));
+    }
+    return menu;
+}
+
+template vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog8 &, const ai::LinearRegression &, bool, int);
+template vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog16 &, const ai::LinearRegression &, bool, int);
+template vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog8 &, const ai::ModelSet &, bool, int, ai::ShadowRecord &);
+template vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog16 &, const ai::ModelSet &, bool, int, ai::ShadowRecord &);
+template vector<shared_ptr<MenuItem>> suggestByTasteProfile(const CompactCatalog8 &, const Taste &, bool);
+template vector<shared_ptr<MenuItem>> suggestByTasteProfile(const CompactCatalog16 &, const Taste &, bool);
+
+} // namespace menu
@@ -0,0 +1,37 @@
+#ifndef SUGGEST_HPP
+#define SUGGEST_HPP
+
+#include <memory>
+#include <vector>
+#include "AI.hpp"
+#include "Catalog.hpp"
+#include "CompactCatalog.hpp"
+#include "Menu.hpp"
+#include "Shadow.hpp"
+#include "Taste.hpp"
+
+namespace menu {
+
+// average taste of a suggested menu (neutral if empty)
+Taste tasteVectorFromMenu(const std::vector<std::shared_ptr<MenuItem>> &menu);
+Taste tasteVectorFromMenu(const Menu &m);
+
+// generate many random candidate full-menus and pick the one with highest predicted satisfaction
+std::vector<std::shared_ptr<MenuItem>> suggestRandomMenuBest(const Catalog &catalog, const ai::LinearRegression &model, bool preferVeg = false, int samples = 30);
+// as above with shadow models: each candidate is scored by every model in one pass, the
+// primary (model 0) picks, and what every model made of the request goes to `record`
+std::vector<std::shared_ptr<MenuItem>> suggestRandomMenuBest(const Catalog &catalog, const ai::ModelSet &models, bool preferVeg, int samples, ai::ShadowRecord &record);
+// per category, the item closest (euclidean) to the given taste profile
+std::vector<std::shared_ptr<MenuItem>> suggestByTasteProfile(const Catalog &catalog, const Taste &profile, bool preferVeg = false);
+
+// same two suggestions over quantized storage; instantiated for CompactCatalog8/16
+template <class Q>
+std::vector<std::shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog<Q> &catalog, const ai::LinearRegression &model, bool preferVeg = false, int samples = 30);
+template <class Q>
+std::vector<std::shared_ptr<MenuItem>> suggestRandomMenuBest(const CompactCatalog<Q> &catalog, const ai::ModelSet &models, bool preferVeg, int samples, ai::ShadowRecord &record);
+template <class Q>
+std::vector<std::shared_ptr<MenuItem>> suggestByTasteProfile(const CompactCatalog<Q> &catalog, const Taste &profile, bool preferVeg = false);
+
+} // namespace menu
+
+#endif
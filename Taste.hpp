@@ -0,0 +1,97 @@
+#ifndef TASTE_HPP
+#define TASTE_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// number of taste dimensions in this build; override with -DMENU_TASTE_DIMS=8 etc.
+#ifndef MENU_TASTE_DIMS
+#define MENU_TASTE_DIMS 5
+#endif
+
+namespace menu {
+
+// ========== TASTE SPACE ==========
+// JSON key of each dimension, in storage order. The first five are the
+// original taste space; a build with N dimensions uses the first N names.
+constexpr std::array<std::string_view, 16> kTasteNames = {{
+    "sweet", "salty", "sour", "bitter", "savory",
+    "umami", "fat", "texture", "temperature", "aroma",
+    "acidity", "astringency", "richness", "crunch", "heat", "freshness"
+}};
+
+template <std::size_t N>
+using TasteVec = std::array<double, N>;
+
+constexpr std::size_t kTasteDims = MENU_TASTE_DIMS;
+static_assert(kTasteDims >= 1 && kTasteDims <= kTasteNames.size(), "MENU_TASTE_DIMS out of range");
+
+using Taste = TasteVec<kTasteDims>;
+
+template <std::size_t N>
+constexpr TasteVec<N> uniformTaste(double v) {
+    TasteVec<N> t{};
+    for (auto &x : t) x = v;
+    return t;
+}
+
+inline Taste neutralTaste() { return uniformTaste<kTasteDims>(0.5); }
+
+// "sweet salty sour bitter savory" for prompts, in storage order
+inline std::string tasteDimNames() {
+    std::string s;
+    for (std::size_t i = 0; i < kTasteDims; ++i) {
+        if (i) s += ' ';
+        s += kTasteNames[i];
+    }
+    return s;
+}
+
+// ========== KERNELS ==========
+namespace detail {
+template <class F, std::size_t... I>
+inline double sumUnrolled(F &&f, std::index_sequence<I...>) {
+    return (0.0 + ... + f(std::integral_constant<std::size_t, I>{}));
+}
+} // namespace detail
+
+// f(0) + ... + f(N-1); fully unrolled at compile time for the common sizes
+// (5, 8, 16 and anything up to 16), a plain loop beyond that
+template <std::size_t N, class F>
+inline double sumOver(F &&f) {
+    if constexpr (N <= 16) {
+        return detail::sumUnrolled(f, std::make_index_sequence<N>{});
+    } else {
+        double s = 0;
+        for (std::size_t i = 0; i < N; ++i) s += f(i);
+        return s;
+    }
+}
+
+template <std::size_t N>
+inline double dot(const double *a, const double *b) {
+    return sumOver<N>([&](auto i) { return a[i] * b[i]; });
+}
+
+template <std::size_t N>
+inline double distance2(const double *a, const double *b) {
+    return sumOver<N>([&](auto i) { double d = a[i] - b[i]; return d*d; });
+}
+
+template <std::size_t N>
+inline double euclidean(const TasteVec<N> &a, const TasteVec<N> &b) {
+    return std::sqrt(distance2<N>(a.data(), b.data()));
+}
+
+template <std::size_t N>
+inline void addTaste(TasteVec<N> &sum, const TasteVec<N> &t) {
+    sumOver<N>([&](auto i) { sum[i] += t[i]; return 0.0; });
+}
+
+} // namespace menu
+
+#endif
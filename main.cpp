@@ -1,4 +1,14 @@
 #include "Menu.hpp"
+#include "Catalog.hpp"
+#include "CompactCatalog.hpp"
+#include "Shard.hpp"
+#include "Session.hpp"
+#include "Suggest.hpp"
+#include "LoadGen.hpp"
+#include "Serializer.hpp"
+#include "AllocTracker.hpp"
+#include "ModelSelect.hpp"
+#include "Shadow.hpp"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
@@ -10,263 +20,177 @@
 #include <iomanip>
 #include <cctype>
 #include <limits>
+#include <chrono>
+#include <sstream>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 using namespace std;
 using json = nlohmann::json;
 using namespace menu;
 
-// normalize JSON category keys to internal names
-static string normalizeCategory(const string &cat) {
-    string low = cat;
-    for (auto &c : low) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
-    if (low == "starters" || low == "starter") return "Starter";
-    if (low == "salads" || low == "salad") return "Salad";
-    if (low == "main_courses" || low == "main_course" || low == "maincourse" || low == "maincourses") return "MainCourse";
-    if (low == "drinks" || low == "drink") return "Drink";
-    if (low == "appetizers" || low == "appetizer") return "Appetizer";
-    if (low == "desserts" || low == "dessert") return "Dessert";
-    if (!low.empty()) { low[0] = static_cast<char>(toupper(static_cast<unsigned char>(low[0]))); return low; }
-    return cat;
+static void showSuggestedMenu(const vector<shared_ptr<MenuItem>> &m, OutputFormat fmt = OutputFormat::Text) {
+    string &out = outputBuffer();
+    if (fmt == OutputFormat::Text) out += "\n-- Suggested Menu --\n";
+    writeMenu(out, m, fmt);
+    flushOutput(out);
+    cout << fixed << setprecision(2); // later output keeps the 2-decimal format, as before
 }
 
-// parse taste from various JSON forms
-static vector<double> parseTasteFromJson(const json &it) {
-    vector<double> t(5, 0.5); // order: sweet, salty, sour, bitter, spicy
-    if (it.contains("taste")) {
-        if (it["taste"].is_array()) {
-            size_t idx = 0;
-            for (auto &v : it["taste"]) if (idx < 5) t[idx++] = v.get<double>();
-            return t;
-        }
-        if (it["taste"].is_object()) {
-            auto &tb = it["taste"];
-            auto getv = [&](const string &k)->double {
-                if (tb.contains(k) && tb[k].is_number()) return tb[k].get<double>();
-                return 0.5;
-            };
-            t[0] = getv("sweet");
-            t[1] = getv("salty");
-            t[2] = getv("sour");
-            t[3] = getv("bitter");
-            t[4] = tb.contains("spicy") ? getv("spicy") : getv("savory");
-            return t;
+int main(int argc, char **argv) {
+    // --quantized=8|16 keeps the catalog in a CompactCatalog instead of the JSON tree;
+    // --shards=N [--shard-by=hash|category] spreads the taste-profile scan over N worker processes;
+    // --session=ID [--session-file=path] keeps this diner's order across runs;
+    // --loadgen [--qps=... see LoadGen.hpp] runs the synthetic load generator instead;
+    // --output=jsonl prints suggested menus as JSON lines;
+    // --alloc-report [--alloc-budget=BYTES] profiles each suggestion request (needs -DMENU_ALLOC_TRACKING);
+    // --select-model [--feedback=path --folds=K --search-threads=N] tunes the model on recorded ratings;
+    // --catalog=dir|manifest|file [--catalog-threads=N] loads the catalog from several files (default menu.json);
+    // --shadow=a.json,b.json [--shadow-log=path] scores shadow models next to the live one and logs them
+    int quantBits = 0;
+    OutputFormat outputFormat = OutputFormat::Text;
+    bool loadGen = false;
+    LoadGenConfig loadGenCfg;
+    long long sessionId = -1;
+    string sessionFile = "sessions.dat";
+    size_t shards = 0;
+    ShardBy shardBy = ShardBy::Hash;
+    bool allocReport = false;
+    uint64_t allocBudget = 0;
+    bool selectModel = false;
+    string catalogPath = "menu.json";
+    unsigned catalogThreads = 0;
+    vector<string> shadowFiles;
+    string shadowLogFile = "shadow_log.jsonl";
+    ai::ModelSelectConfig selectCfg;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--quantized=", 0) == 0) quantBits = atoi(arg.c_str() + 12);
+        else if (arg.rfind("--shards=", 0) == 0) shards = static_cast<size_t>(max(0, atoi(arg.c_str() + 9)));
+        else if (arg == "--shard-by=category") shardBy = ShardBy::Category;
+        else if (arg == "--shard-by=hash") shardBy = ShardBy::Hash;
+        else if (arg.rfind("--session=", 0) == 0) sessionId = atoll(arg.c_str() + 10);
+        else if (arg.rfind("--session-file=", 0) == 0) sessionFile = arg.substr(15);
+        else if (arg == "--loadgen") loadGen = true;
+        else if (arg == "--output=jsonl") outputFormat = OutputFormat::JsonLines;
+        else if (arg == "--output=text") outputFormat = OutputFormat::Text;
+        else if (arg == "--alloc-report") allocReport = true;
+        else if (arg.rfind("--alloc-budget=", 0) == 0) allocBudget = strtoull(arg.c_str() + 15, nullptr, 10);
+        else if (arg == "--select-model") selectModel = true;
+        else if (arg.rfind("--shadow=", 0) == 0) {
+            stringstream list(arg.substr(9));
+            for (string f; getline(list, f, ',');) if (!f.empty()) shadowFiles.push_back(f);
         }
+        else if (arg.rfind("--shadow-log=", 0) == 0) shadowLogFile = arg.substr(13);
+        else if (arg.rfind("--catalog=", 0) == 0) catalogPath = arg.substr(10);
+        else if (arg.rfind("--catalog-threads=", 0) == 0) catalogThreads = static_cast<unsigned>(max(0, atoi(arg.c_str() + 18)));
+        else if (parseLoadGenArg(arg, loadGenCfg)) {}
+        else if (ai::parseModelSelectArg(arg, selectCfg)) {}
     }
-
-    if (it.contains("taste_balance")) {
-        if (it["taste_balance"].is_number()) {
-            double tb = it["taste_balance"].get<double>();
-            return vector<double>(5, tb);
-        }
-        if (it["taste_balance"].is_object()) {
-            auto &tb = it["taste_balance"];
-            auto getv = [&](const string &k)->double {
-                if (tb.contains(k) && tb[k].is_number()) return tb[k].get<double>();
-                return 0.5;
-            };
-            t[0] = getv("sweet");
-            t[1] = getv("salty");
-            t[2] = getv("sour");
-            t[3] = getv("bitter");
-            t[4] = tb.contains("spicy") ? getv("spicy") : getv("savory");
-            return t;
-        }
+    if ((allocReport || allocBudget) && !kAllocTracking)
+        cerr << "Warning: --alloc-report/--alloc-budget need a build with -DMENU_ALLOC_TRACKING; ignored\n";
+    loadGenCfg.allocReport = allocReport;
+    loadGenCfg.allocBudget = allocBudget;
+    loadGenCfg.shadowFiles = shadowFiles;
+    loadGenCfg.shadowLog = shadowLogFile;
+    if (quantBits != 0 && quantBits != 8 && quantBits != 16) {
+        cerr << "Unsupported --quantized=" << quantBits << " (use 8 or 16)\n";
+        return 1;
     }
 
-    return t;
-}
+    // offline: pick learning rate, L2 and epochs from the recorded ratings
+    if (selectModel) return ai::runModelSelection(selectCfg);
 
-static map<string, vector<json>> buildCatalog(const json &menuData) {
-    map<string, vector<json>> catalog;
-    if (menuData.is_null()) return catalog;
-    for (auto& [category, items] : menuData.items()) {
-        string cat = normalizeCategory(category);
-        for (auto& it : items) catalog[cat].push_back(it);
-    }
+    cout << "==============================\n";
+    cout << "  Welcome to Restaurant Bot 🍽️\n";
+    cout << "==============================\n\n";
 
-    // ensure each main category has at least 2 items
-    vector<string> required = {"Starter","Salad","MainCourse","Drink","Appetizer","Dessert"};
-    for (auto &cat : required) {
-        auto &vec = catalog[cat]; // creates empty vector if not present
-        if (vec.size() == 0) {
-            json ph;
-            ph["name"] = string("Placeholder ") + cat;
-            ph["price"] = 0.0;
-            ph["taste_balance"] = json::object({ {"sweet",0.5}, {"salty",0.5}, {"sour",0.5}, {"bitter",0.5}, {"savory",0.5} });
-            vec.push_back(ph);
-            vec.push_back(ph);
-        } else if (vec.size() == 1) {
-            // duplicate existing to reach 2
-            vec.push_back(vec.front());
+    auto sources = catalogSources(catalogPath);
+    // shards are forked before the catalog exists and load their own slices of the sources
+    unique_ptr<ShardedCatalog> sharded;
+    string shardError;
+    if (shards > 0) {
+        try {
+            sharded = make_unique<ShardedCatalog>(sources, shards, shardBy);
+        } catch (const std::exception &e) {
+            shardError = e.what();
         }
     }
-
-    return catalog;
-}
-
-static shared_ptr<MenuItem> makeItemFromJson(const string &category, const json &it) {
-    string n = it.value("name", string());
-    double p = it.value("price", 0.0);
-    vector<double> t = parseTasteFromJson(it);
-
-    // vegetarian flag
-    bool isVeg = false;
-    if (it.contains("vegetarian") && it["vegetarian"].is_boolean()) {
-        isVeg = it["vegetarian"].get<bool>();
-    } else {
-        string low = n;
-        for (auto &c : low) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
-        if (low.find("veg") != string::npos || low.find("vegetable") != string::npos) isVeg = true;
+    if (shards > 0 && !sharded) cerr << "Warning: could not start shards (" << shardError << "), using a single process\n";
+    // the shards hold the catalog; the main process only loads it when it scans by itself
+    CatalogLoadStats loaded;
+    Catalog catalog;
+    if (sharded) loaded = sharded->loadStats();
+    else catalog = loadCatalogFiles(sources, catalogThreads, &loaded);
+    if (loaded.parsed == 0) cout << "\n⚠️ Could not load " << catalogPath << ". No catalog items are available.\n";
+    else if (sources.size() == 1) cout << "\nMenu loaded from " << sources[0] << " successfully!\n";
+    else cout << "\nMenu loaded from " << loaded.parsed << " of " << loaded.files << " files: " << loaded.items
+              << " items, " << loaded.duplicates << " duplicates merged\n";
+    if (quantBits && sharded) {
+        cerr << "Warning: --quantized has no effect with --shards; the catalog stays in the shards\n";
+        quantBits = 0;
     }
-
-    // category uses normalized names
-    if (category == "Starter") return make_shared<Starter>(n,p,t);
-    if (category == "Salad") return make_shared<Salad>(n,p,t);
-    if (category == "MainCourse") return make_shared<MainCourse>(n,p,t,isVeg);
-    if (category == "Drink") return make_shared<Drink>(n,p,t);
-    if (category == "Appetizer") return make_shared<Appetizer>(n,p,t);
-    if (category == "Dessert") return make_shared<Dessert>(n,p,t);
-    // fallback
-    return make_shared<Starter>(n,p,t);
-}
-
-static vector<double> tasteVectorFromMenu(const vector<shared_ptr<MenuItem>> &menu) {
-    vector<double> avg(5,0.0);
-    if (menu.empty()) return vector<double>(5,0.5);
-    for (auto &it : menu) {
-        auto t = it->getTaste();
-        for (size_t i=0;i<5;++i) avg[i] += t[i];
+    unique_ptr<CompactCatalog8> compact8;
+    unique_ptr<CompactCatalog16> compact16;
+    if (quantBits == 8) compact8 = make_unique<CompactCatalog8>(catalog);
+    if (quantBits == 16) compact16 = make_unique<CompactCatalog16>(catalog);
+    // the compact catalog holds everything the bot reads, so the JSON tree is dropped
+    if (quantBits) {
+        catalog.clear();
+#ifdef __GLIBC__
+        malloc_trim(0); // the tree was many small blocks; hand their pages back to the OS
+#endif
+        cout << "Using " << quantBits << "-bit compact catalog ("
+             << (compact8 ? compact8->memoryBytes() : compact16->memoryBytes()) << " bytes, JSON catalog released)\n";
     }
-    for (size_t i=0;i<5;++i) avg[i] /= menu.size();
-    return avg;
-}
-
-static vector<double> tasteVectorFromMenu(const Menu &m) {
-    return m.getTasteAvg();
-}
-
-static double euclidean(const vector<double> &a, const vector<double> &b) {
-    double s=0;
-    size_t n = min(a.size(), b.size());
-    for (size_t i=0;i<n;++i) {
-        double d = a[i]-b[i];
-        s += d*d;
+    JsonCatalogView jsonView(catalog); // empty when sharded
+    unique_ptr<ShardedCatalogView> shardedView;
+    if (sharded) shardedView = make_unique<ShardedCatalogView>(*sharded);
+    const CatalogView &catalogView = compact8 ? static_cast<const CatalogView &>(*compact8)
+                                   : compact16 ? static_cast<const CatalogView &>(*compact16)
+                                   : shardedView ? static_cast<const CatalogView &>(*shardedView) : jsonView;
+    if (sharded) cout << "Catalog split over " << sharded->shardCount() << " shard processes ("
+                      << sharded->itemCount() << " items)\n";
+
+    // headless: synthetic diners instead of the interactive session
+    if (loadGen) {
+        LoadGenCatalog source;
+        if (compact8) source.compact8 = compact8.get();
+        else if (compact16) source.compact16 = compact16.get();
+        else if (!sharded) source.catalog = &catalog;
+        source.sharded = sharded.get();
+        return runLoadGen(loadGenCfg, source);
     }
-    return sqrt(s);
-}
 
-// generate many random candidate full-menus and pick the one with highest predicted satisfaction
-static vector<shared_ptr<MenuItem>> suggestRandomMenuBest(const map<string, vector<json>> &catalog, ai::LinearRegression &model, bool preferVeg=false, int samples=30) {
-    vector<shared_ptr<MenuItem>> bestMenu;
-    double bestScore = std::numeric_limits<double>::lowest();
-    random_device rd; mt19937 gen(rd());
-    for (int s=0;s<samples;++s) {
-        vector<shared_ptr<MenuItem>> cand;
-        for (auto &kv : catalog) {
-            const auto &vec = kv.second;
-            if (vec.empty()) continue;
-
-            vector<size_t> candidates;
-            for (size_t i=0;i<vec.size();++i) {
-                const json &entry = vec[i];
-                if (kv.first == "MainCourse" && preferVeg) {
-                    bool isVeg = false;
-                    if (entry.contains("vegetarian") && entry["vegetarian"].is_boolean()) isVeg = entry["vegetarian"].get<bool>();
-                    else {
-                        string nm = entry.value("name", string());
-                        string low = nm;
-                        for (auto &c : low) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
-                        if (low.find("veg") != string::npos || low.find("vegetable") != string::npos) isVeg = true;
-                    }
-                    if (!isVeg) continue;
-                }
-                candidates.push_back(i);
-            }
-
-            if (candidates.empty()) {
-                for (size_t i=0;i<vec.size();++i) candidates.push_back(i);
-            }
-
-            uniform_int_distribution<size_t> dist(0, candidates.size()-1);
-            size_t chosen = candidates[dist(gen)];
-            cand.push_back(makeItemFromJson(kv.first, vec[chosen]));
-        }
-        if (cand.empty()) continue;
-        auto taste = tasteVectorFromMenu(cand);
-        double score = model.predict(taste);
-        if (score > bestScore) { bestScore = score; bestMenu = cand; }
+    // a known session brings back the diner and their open order
+    User user;
+    unique_ptr<SessionStore> sessions;
+    bool restored = false;
+    if (sessionId >= 0) {
+        // sharded: no catalog to index, so items are kept whole in the session
+        sessions = make_unique<SessionStore>(sharded ? static_cast<const CatalogView &>(jsonView) : catalogView, sessionFile);
+        restored = sessions->load(static_cast<SessionStore::SessionId>(sessionId), user);
     }
-    return bestMenu;
-}
-
-static vector<shared_ptr<MenuItem>> suggestByTasteProfile(const map<string, vector<json>> &catalog, const vector<double> &profile, ai::LinearRegression &model, bool preferVeg=false) {
-    vector<shared_ptr<MenuItem>> menu;
-    for (auto &kv : catalog) {
-        const auto &vec = kv.second;
-        if (vec.empty()) continue;
-        double bestDist = 1e18;
-        int bestIdx = -1;
-        for (size_t i = 0; i < vec.size(); ++i) {
-            const json &candidate = vec[i];
-            if (kv.first == "MainCourse" && preferVeg) {
-                bool isVeg = false;
-                if (candidate.contains("vegetarian") && candidate["vegetarian"].is_boolean()) isVeg = candidate["vegetarian"].get<bool>();
-                else {
-                    string nm = candidate.value("name", string());
-                    string low = nm;
-                    for (auto &c : low) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
-                    if (low.find("veg") != string::npos || low.find("vegetable") != string::npos) isVeg = true;
-                }
-                if (!isVeg) continue; // skip non-veg
-            }
-            vector<double> t = parseTasteFromJson(candidate);
-            double d = euclidean(t, profile);
-            if (d < bestDist) { bestDist = d; bestIdx = static_cast<int>(i); }
-        }
-        if (bestIdx >= 0) menu.push_back(makeItemFromJson(kv.first, vec[bestIdx]));
-        else {
-            auto fallback = min_element(vec.begin(), vec.end(), [&](const json &a, const json &b){
-                vector<double> ta = parseTasteFromJson(a), tb = parseTasteFromJson(b);
-                return euclidean(ta, profile) < euclidean(tb, profile);
-            });
-            if (fallback != vec.end()) menu.push_back(makeItemFromJson(kv.first, *fallback));
-        }
+    if (!restored) {
+        string fname, lname, gender;
+        cout << "\nEnter your first name: ";
+        cin >> fname;
+        cout << "Enter your last name: ";
+        cin >> lname;
+        cout << "Enter your gender (M/F): ";
+        cin >> gender;
+        user = User(fname, lname, gender);
     }
-    return menu;
-}
-
-static void showSuggestedMenu(const vector<shared_ptr<MenuItem>> &m) {
-    cout << "\n-- Suggested Menu --\n";
-    double total = 0;
-    for (auto &it : m) { it->printInfo(); total += it->getPrice(); }
-    cout << "Total Cost: $" << fixed << setprecision(2) << total << "\n";
-}
-
-int main() {
-    cout << "==============================\n";
-    cout << "  Welcome to Restaurant Bot 🍽️\n";
-    cout << "==============================\n\n";
-
-    string fname, lname, gender;
-    cout << "Enter your first name: ";
-    cin >> fname;
-    cout << "Enter your last name: ";
-    cin >> lname;
-    cout << "Enter your gender (M/F): ";
-    cin >> gender;
-
-    User user(fname, lname, gender);
     user.showInfo();
-
-    json menuData;
-    ifstream file("menu.json");
-    if (file.is_open()) { file >> menuData; cout << "\nMenu loaded from menu.json successfully!\n"; }
-    else cout << "\n⚠️ Could not open menu.json. Default items will be used.\n";
-
-    auto catalog = buildCatalog(menuData);
+    if (restored) { cout << "Restored your open order:\n"; user.getMenu().showMenu(); }
 
     cout << "\nDo you want a menu suggestion? (1=Random+AI, 2=By taste profile, 0=Skip): ";
     int suggestChoice; cin >> suggestChoice;
+    if (suggestChoice == 1 && sharded) {
+        cout << "Random+AI needs the whole catalog, which stays in the shards; not available with --shards.\n";
+        suggestChoice = 0;
+    }
 
     cout << "Prefer vegetarian main course? (1=yes, 0=no): ";
     int pv; cin >> pv;
@@ -275,46 +199,110 @@ int main() {
     ai::LinearRegression model(0.01);
     model.loadWeights("weights.json");
 
-    if (suggestChoice == 1) {
-        auto sug = suggestRandomMenuBest(catalog, model, preferVeg, 40);
-        if (sug.empty()) cout << "No items available for suggestion.\n";
-        else {
-            showSuggestedMenu(sug);
-            cout << "Enter your satisfaction for this suggestion (0-1, or -1 to skip): ";
-            double satisfaction; cin >> satisfaction;
-            if (satisfaction >= 0.0 && satisfaction <= 1.0) {
-                auto taste = tasteVectorFromMenu(sug);
-                model.train(taste, satisfaction);
-                model.saveWeights("weights.json");
-                cout << "Model updated.\n";
-            }
-        }
-    } else if (suggestChoice == 2) {
-        cout << "Enter your taste balance (sweet sour bitter salty savory) as 5 numbers: ";
-        vector<double> taste(5);
-        for (double &v : taste) cin >> v;
-        auto sug = suggestByTasteProfile(catalog, taste, model, preferVeg);
-        if (sug.empty()) cout << "No items available for suggestion.\n";
-        else {
-            double score = model.predict(tasteVectorFromMenu(sug));
-            cout << "Predicted satisfaction for this suggested menu: " << score << "\n";
-            showSuggestedMenu(sug);
-            cout << "Your satisfaction score (0–1): ";
-            double rating; cin >> rating;
-            if (rating >= 0.0 && rating <= 1.0) {
-                model.train(taste, rating);
-                model.saveWeights("weights.json");
-                cout << "Weights updated and saved!\n";
+    // shadow models are scored next to the primary and logged, never served
+    unique_ptr<ai::ModelSet> shadows;
+    unique_ptr<ai::ShadowLog> shadowLog;
+    if (!shadowFiles.empty()) {
+        shadows = make_unique<ai::ModelSet>(model);
+        for (auto &f : shadowFiles) shadows->addFromFile(f);
+        if (shadows->size() > 1) shadowLog = make_unique<ai::ShadowLog>(shadowLogFile);
+        if (!shadowLog || !shadowLog->isOpen()) { shadows.reset(); shadowLog.reset(); }
+    }
+    const uint64_t requestId = static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(
+        chrono::system_clock::now().time_since_epoch()).count());
+    auto logShadow = [&](const char *mode, const ai::ShadowRecord &r) {
+        string &out = outputBuffer();
+        ai::writeShadowRecord(out, requestId, mode, r, *shadows);
+        shadowLog->write(out);
+    };
+    auto logShadowRating = [&](double rating) {
+        string &out = outputBuffer();
+        ai::writeShadowRating(out, requestId, rating);
+        shadowLog->write(out);
+    };
+
+    AllocStats allocStats;
+    {
+        AllocRequest request(allocBudget); // the suggestion round trip: candidates, output, training
+        try {
+            if (suggestChoice == 1) {
+                vector<shared_ptr<MenuItem>> sug;
+                ai::ShadowRecord shadowRec;
+                if (shadows) sug = compact8 ? suggestRandomMenuBest(*compact8, *shadows, preferVeg, 40, shadowRec)
+                                 : compact16 ? suggestRandomMenuBest(*compact16, *shadows, preferVeg, 40, shadowRec)
+                                 : suggestRandomMenuBest(catalog, *shadows, preferVeg, 40, shadowRec);
+                else sug = compact8 ? suggestRandomMenuBest(*compact8, model, preferVeg, 40)
+                         : compact16 ? suggestRandomMenuBest(*compact16, model, preferVeg, 40)
+                         : suggestRandomMenuBest(catalog, model, preferVeg, 40);
+                if (sug.empty()) cout << "No items available for suggestion.\n";
+                else {
+                    if (shadows) logShadow("random", shadowRec);
+                    showSuggestedMenu(sug, outputFormat);
+                    cout << "Enter your satisfaction for this suggestion (0-1, or -1 to skip): ";
+                    double satisfaction; cin >> satisfaction;
+                    if (satisfaction >= 0.0 && satisfaction <= 1.0) {
+                        auto taste = tasteVectorFromMenu(sug);
+                        model.train(taste, satisfaction);
+                        ai::appendFeedback(selectCfg.feedbackFile, taste, satisfaction);
+                        if (shadows) logShadowRating(satisfaction);
+                        model.saveWeights("weights.json");
+                        cout << "Model updated.\n";
+                    }
+                }
+            } else if (suggestChoice == 2) {
+                cout << "Enter your taste balance (" << tasteDimNames() << ") as " << kTasteDims << " numbers: ";
+                Taste taste;
+                for (double &v : taste) cin >> v;
+                auto sug = sharded ? sharded->suggestByTasteProfile(taste, preferVeg)
+                         : compact8 ? suggestByTasteProfile(*compact8, taste, preferVeg)
+                         : compact16 ? suggestByTasteProfile(*compact16, taste, preferVeg)
+                         : suggestByTasteProfile(catalog, taste, preferVeg);
+                if (sug.empty()) cout << "No items available for suggestion.\n";
+                else {
+                    Taste menuTaste = tasteVectorFromMenu(sug);
+                    double score = model.predict(menuTaste);
+                    if (shadows) {
+                        ai::ShadowRecord shadowRec;
+                        shadowRec.served.resize(shadows->size());
+                        shadows->scoreAll(menuTaste.data(), shadowRec.served.data());
+                        logShadow("profile", shadowRec);
+                    }
+                    cout << "Predicted satisfaction for this suggested menu: " << score << "\n";
+                    showSuggestedMenu(sug, outputFormat);
+                    cout << "Your satisfaction score (0–1): ";
+                    double rating; cin >> rating;
+                    if (rating >= 0.0 && rating <= 1.0) {
+                        model.train(taste, rating);
+                        ai::appendFeedback(selectCfg.feedbackFile, taste, rating);
+                        if (shadows) logShadowRating(rating);
+                        model.saveWeights("weights.json");
+                        cout << "Weights updated and saved!\n";
+                    }
+                }
             }
+        } catch (const AllocBudgetExceeded &e) {
+            cout << "Suggestion aborted: " << e.what() << "\n";
         }
+        allocStats = request.stats();
+    }
+    if (allocReport && kAllocTracking && suggestChoice != 0) {
+        string &out = outputBuffer();
+        out += "Allocations: ";
+        writeAllocReport(out, allocStats);
+        out += '\n';
+        flushOutput(out);
     }
 
     // pass catalog into interact so user can pick existing items per category
-    user.interact(catalog);
+    user.interact(catalogView);
+    if (sessions) {
+        sessions->save(static_cast<SessionStore::SessionId>(sessionId), user);
+        sessions->evictAll(); // write it to the session file for the next run
+    }
 
     cout << "\nLet's evaluate your menu experience! (0–1 satisfaction)\n";
-    vector<double> taste(5);
-    cout << "Enter your taste balance (sweet salty sour bitter spicy): ";
+    Taste taste;
+    cout << "Enter your taste balance (" << tasteDimNames() << "): ";
     for (double &v : taste) cin >> v;
 
     double rating;
@@ -326,6 +314,7 @@ int main() {
     cout << "Actual satisfaction: " << rating << endl;
 
     model.train(taste, rating);
+    ai::appendFeedback(selectCfg.feedbackFile, taste, rating);
     model.saveWeights("weights.json");
 
     cout << "Weights updated and saved!\n";